@@ -278,6 +278,7 @@ private struct ReplaySample {
     let axis3: Double
     let axis4: Double
     let action: String
+    var heading: Double? = nil
 }
 
 private struct ReplayPose {
@@ -318,6 +319,7 @@ private enum ReplayParser {
         var x = settings.fieldSizeIn / 2.0
         var y = settings.fieldSizeIn / 2.0
         var theta = 0.0
+        var headingOffset: Double?
         var lastT: Double?
 
         for sample in samples {
@@ -343,6 +345,13 @@ private enum ReplayParser {
                 theta += omega * dt
             }
 
+            if let heading = sample.heading {
+                // IMU heading is clockwise degrees; anchor it to the pose at the first telemetry tick.
+                let offset = headingOffset ?? (theta + heading * .pi / 180.0)
+                headingOffset = offset
+                theta = offset - heading * .pi / 180.0
+            }
+
             poses.append(
                 ReplayPose(
                     t: sample.time,
@@ -404,6 +413,7 @@ private enum ReplayParser {
         var axis3: Double?
         var axis4: Double?
         var lastAction = ""
+        var lastHeading: Double?
         var t = 0.0
 
         for line in lines {
@@ -421,12 +431,44 @@ private enum ReplayParser {
                 axis3 = parseDouble(value)
             case "AXIS4":
                 axis4 = parseDouble(value)
+            case "TELEM":
+                // Motor/IMU telemetry track; only the IMU heading is used for replay.
+                if let token = value.split(separator: " ").first(where: { $0.uppercased().hasPrefix("H=") }),
+                   let heading = Double(token.dropFirst(2)) {
+                    lastHeading = heading
+                }
+                continue
+            case "CHECKPOINT":
+                // Segment CRC written by the brain for crash recovery; not a driver action.
+                continue
+            case "DT_US":
+                // Measured period before the next sample; replaces the 20 ms assumption.
+                if let last = samples.last, let dtUs = Double(value.trimmingCharacters(in: .whitespaces)), dtUs > 0 {
+                    t = last.time + dtUs / 1_000_000.0
+                }
+                continue
+            case "REPEAT":
+                // Delta-mode logs: the previous sample held for N more ticks. "REPEAT : N US"
+                // carries their summed period; older logs without it mean 20 ms ticks.
+                let fields = value.split(separator: " ")
+                if let last = samples.last, let first = fields.first, let count = Int(first), count > 0 {
+                    var step = 0.02
+                    if fields.count > 1, let totalUs = Double(fields[1]), totalUs > 0 {
+                        step = totalUs / 1_000_000.0 / Double(count)
+                    }
+                    t = last.time + step
+                    for _ in 0..<count {
+                        samples.append(ReplaySample(time: t, axis1: last.axis1, axis2: last.axis2, axis3: last.axis3, axis4: last.axis4, action: last.action, heading: last.heading))
+                        t += step
+                    }
+                }
+                continue
             default:
                 lastAction = "\(kind) : \(value)"
             }
 
             if let a1 = axis1, let a2 = axis2, let a3 = axis3, let a4 = axis4 {
-                samples.append(ReplaySample(time: t, axis1: a1, axis2: a2, axis3: a3, axis4: a4, action: lastAction))
+                samples.append(ReplaySample(time: t, axis1: a1, axis2: a2, axis3: a3, axis4: a4, action: lastAction, heading: lastHeading))
                 axis1 = nil
                 axis2 = nil
                 axis3 = nil
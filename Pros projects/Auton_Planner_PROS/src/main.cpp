@@ -1,13 +1,39 @@
 #include "main.h"
+#include "sd_manifest.hpp"
+#include "image_codec.hpp"
+#include "auton_steps.hpp"
 
 #include <algorithm>
+#include <cctype>
+#include <cerrno>
 #include <cmath>
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
+#include <memory>
+#include <new>
 #include <string>
 #include <vector>
 
+#ifndef EMBED_JERKBOT
+#define EMBED_JERKBOT 0
+#endif
+#if EMBED_JERKBOT
+#include "hot-cold-asset/asset.hpp"
+ASSET(jerkbot_v5img)
+#endif
+
+using image_codec::BmpInfo;
+using image_codec::ScaleFilter;
+using image_codec::V5ImgInfo;
+using image_codec::draw_bmp_fast;
+using image_codec::draw_bmp_streaming;
+using image_codec::draw_v5img;
+using image_codec::ends_with_v5img;
+using image_codec::read_bmp_info;
+using image_codec::read_v5img_info;
+using image_codec::v5img_sibling;
+
 // =====================================================
 // SIMPLE AUTON PLANNER (NO LEMLIB)
 // =====================================================
@@ -26,66 +52,12 @@ pros::Gps gps(21);
 namespace {
 // Optional: SD image (place at /usd/Images/jerkbot.bmp or /usd/jerkbot.bmp)
 constexpr char kJerkbotName[] = "jerkbot.bmp";
+constexpr char kEmbeddedJerkbot[] = "jerkbot.v5img";
+constexpr int kScreenW = 480;
+constexpr int kScreenH = 240;
 
-bool starts_with(const char* str, const char* prefix) {
-    if (!str || !prefix) {
-        return false;
-    }
-    const std::size_t prefix_len = std::strlen(prefix);
-    return std::strncmp(str, prefix, prefix_len) == 0;
-}
-
-bool try_mount_sd() {
-    char buffer[64] = {0};
-    errno = 0;
-    return pros::usd::list_files("/", buffer, sizeof(buffer)) != PROS_ERR;
-}
-
-FILE* sd_open(const char* name, const char* mode) {
-    if (!name || !mode) {
-        return nullptr;
-    }
-
-    const char* prefixes[] = {
-        "/usd/",
-        "usd/",
-        "/usd/Images/",
-        "/usd/images/",
-        "usd/Images/",
-        "usd/images/",
-    };
-
-    for (int attempt = 0; attempt < 3; ++attempt) {
-        FILE* file = std::fopen(name, mode);
-        if (file) {
-            return file;
-        }
-
-        if (starts_with(name, "usd/")) {
-            char fixed[128];
-            std::snprintf(fixed, sizeof(fixed), "/%s", name);
-            file = std::fopen(fixed, mode);
-            if (file) {
-                return file;
-            }
-        }
-
-        try_mount_sd();
-
-        char path[128];
-        for (const char* prefix : prefixes) {
-            std::snprintf(path, sizeof(path), "%s%s", prefix, name);
-            file = std::fopen(path, mode);
-            if (file) {
-                return file;
-            }
-        }
-
-        pros::delay(50);
-    }
-
-    return nullptr;
-}
+// How images larger than the screen are shrunk.
+constexpr ScaleFilter kScaleFilter = ScaleFilter::BOX;
 }
 
 // =====================================================
@@ -104,55 +76,55 @@ void update_auton_mode_from_controller() {
 }
 
 // =====================================================
-// BMP DRAW (24-bit uncompressed)
+// IMAGE DRAW (.v5img and BMP)
 // =====================================================
-bool draw_bmp_from_sd(const char* name, int x, int y) {
-    FILE* file = sd_open(name, "rb");
-    if (!file) return false;
-
-    std::uint8_t header[54];
-    if (std::fread(header, 1, sizeof(header), file) != sizeof(header)) {
-        std::fclose(file);
-        return false;
+// The jerkbot image built into the program (static/jerkbot.v5img via the hot/cold asset
+// rules), opened as a read-only stream so the .v5img code can draw it. Only asked for
+// when the card has no copy; nullptr for other names or when built with EMBED_JERKBOT=0.
+FILE* open_embedded_image(const char* name) {
+#if EMBED_JERKBOT
+    const char* base = std::strrchr(name, '/');
+    std::string native = v5img_sibling(base ? base + 1 : name);
+    for (char& c : native) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
     }
-
-    const std::uint32_t data_offset = *reinterpret_cast<std::uint32_t*>(&header[10]);
-    const std::int32_t width = *reinterpret_cast<std::int32_t*>(&header[18]);
-    const std::int32_t height = *reinterpret_cast<std::int32_t*>(&header[22]);
-    const std::uint16_t bpp = *reinterpret_cast<std::uint16_t*>(&header[28]);
-    const std::uint32_t compression = *reinterpret_cast<std::uint32_t*>(&header[30]);
-
-    if (bpp != 24 || compression != 0 || width <= 0 || height == 0) {
-        std::fclose(file);
-        return false;
+    if (native == kEmbeddedJerkbot) {
+        return fmemopen(jerkbot_v5img.buf, jerkbot_v5img.size, "rb");
     }
+#else
+    (void)name;
+#endif
+    return nullptr;
+}
 
-    const std::int32_t abs_height = std::abs(height);
-    const std::uint32_t row_size = ((bpp * width + 31) / 32) * 4;
-    std::vector<std::uint8_t> row(row_size);
-
-    std::fseek(file, static_cast<long>(data_offset), SEEK_SET);
-
-    for (std::int32_t row_idx = 0; row_idx < abs_height; ++row_idx) {
-        if (std::fread(row.data(), 1, row_size, file) != row_size) {
-            break;
-        }
-        const std::int32_t draw_y = height > 0 ? (abs_height - 1 - row_idx) : row_idx;
-        for (std::int32_t col = 0; col < width; ++col) {
-            const std::size_t idx = static_cast<std::size_t>(col * 3);
-            const std::uint8_t b = row[idx];
-            const std::uint8_t g = row[idx + 1];
-            const std::uint8_t r = row[idx + 2];
-            const std::uint32_t color = (static_cast<std::uint32_t>(r) << 16) |
-                                        (static_cast<std::uint32_t>(g) << 8) |
-                                        static_cast<std::uint32_t>(b);
-            pros::screen::set_pen(color);
-            pros::screen::draw_pixel(x + col, y + draw_y);
+// Prefers a .v5img sibling the layout probe saw, then the chunked BMP draw, then
+// streaming. Without the file on the card, falls back to the built-in image.
+bool draw_bmp_from_sd(const char* name, int x, int y) {
+    const std::string native = ends_with_v5img(name) ? std::string(name) : v5img_sibling(name);
+    if (sd_manifest::known(native.c_str())) {
+        FILE* file = sd_manifest::open(native.c_str(), "rb");
+        if (file) {
+            V5ImgInfo v5;
+            const bool drawn = read_v5img_info(file, &v5) && draw_v5img(file, v5, x, y);
+            std::fclose(file);
+            if (drawn) return true;
         }
     }
 
+    FILE* file = sd_manifest::open(name, "rb");
+    if (!file) {
+        file = open_embedded_image(name);
+        V5ImgInfo v5;
+        const bool drawn = file && read_v5img_info(file, &v5) && draw_v5img(file, v5, x, y);
+        if (file) std::fclose(file);
+        return drawn;
+    }
+
+    BmpInfo info;
+    const bool ok = read_bmp_info(file, &info) &&
+                    (draw_bmp_fast(file, info, x, y, kScaleFilter) || draw_bmp_streaming(file, info, x, y, kScaleFilter));
     std::fclose(file);
-    return true;
+    return ok;
 }
 
 void draw_jerkbot() {
@@ -168,51 +140,37 @@ void stop_drive() {
     right_drive.brake();
 }
 
-void turn_to_heading(double target, int max_speed) {
-    while (true) {
-        double current = imu.get_heading();
-        double error = target - current;
+// One P-control update towards target; true once within 2 degrees. The step engine
+// calls it every tick and brakes after.
+bool turn_toward_heading(double target, int max_speed) {
+    double current = imu.get_heading();
+    double error = target - current;
 
-        if (error > 180) error -= 360;
-        if (error < -180) error += 360;
+    if (error > 180) error -= 360;
+    if (error < -180) error += 360;
 
-        if (std::abs(error) < 2.0) break;
+    if (std::abs(error) < 2.0) return true;
 
-        double kp = 1.5;
-        int speed = static_cast<int>(error * kp);
+    double kp = 1.5;
+    int speed = static_cast<int>(error * kp);
 
-        if (speed > max_speed) speed = max_speed;
-        if (speed < -max_speed) speed = -max_speed;
+    if (speed > max_speed) speed = max_speed;
+    if (speed < -max_speed) speed = -max_speed;
 
-        left_drive.move(speed);
-        right_drive.move(-speed);
-        pros::delay(20);
-    }
-    stop_drive();
+    left_drive.move(speed);
+    right_drive.move(-speed);
+    return false;
 }
 
 // =====================================================
 // AUTON STEP SYSTEM (EASY TO EDIT)
 // =====================================================
 
-enum class StepType {
-    EMPTY,
-    DRIVE_MS,
-    TANK_MS,
-    TURN_HEADING,
-    WAIT_MS,
-    INTAKE_ON,
-    INTAKE_OFF,
-    OUTTAKE_ON,
-    OUTTAKE_OFF
-};
-
-struct Step {
-    StepType type;
-    int value1; // speed or heading or ms
-    int value2; // duration for DRIVE_MS, right speed for TANK_MS
-    int value3; // duration for TANK_MS
-};
+// Step types, their plan file names and how each one runs live in ../Auton_Steps.
+using auton_steps::Step;
+using auton_steps::StepType;
+using auton_steps::next_step_type;
+using auton_steps::step_type_name;
 
 constexpr int kSlotCount = 3;
 constexpr char kSlot1File[] = "auton_plans_slot1.txt";
@@ -236,46 +194,67 @@ static std::vector<Step> basic_plan = {
     {StepType::DRIVE_MS, 50, 500, 0},
 };
 
+// Wait slice while a drive step ramps between set-points.
+constexpr std::uint32_t kAutonTickMs = 10;
+// Largest change in a drive command per kAutonTickMs when one drive step hands over
+// to the next. 0 switches set-points at once, which replays a recording exactly; 8
+// would spread a full reversal over about 300 ms.
+constexpr int kAutonSlewPerTick = 0;
+constexpr char kAutonProfileFile[] = "auton_profile.txt";
+// WAIT_FOR thresholds: a motor below kStoppedRpm counts as stopped, and an intake
+// drawing more than kStallCurrentMa while stopped counts as stalled.
+constexpr double kStoppedRpm = 5.0;
+constexpr std::int32_t kStallCurrentMa = 2000;
+
+void drive_tank(int left, int right) {
+    left_drive.move(left);
+    right_drive.move(right);
+}
+
+void intake_power(int power) {
+    if (power == 0) {
+        intake_left.brake();
+        intake_right.brake();
+    } else {
+        intake_left.move(power);
+        intake_right.move(power);
+    }
+}
+
+// WAIT_FOR conditions (auton_steps::Condition).
+bool auton_condition(int id) {
+    switch (id) {
+        case auton_steps::kDriveStopped:
+            return std::abs(left_drive.get_actual_velocity()) < kStoppedRpm &&
+                   std::abs(right_drive.get_actual_velocity()) < kStoppedRpm;
+        case auton_steps::kIntakeStalled:
+            return intake_left.get_current_draw() > kStallCurrentMa &&
+                   std::abs(intake_left.get_actual_velocity()) < kStoppedRpm;
+        default:
+            return false;
+    }
+}
+
+// Runs plan on the shared step engine and writes its per-step timings to
+// auton_profile.txt.
 void run_plan(const std::vector<Step>& plan) {
-    for (const Step& step : plan) {
-        switch (step.type) {
-            case StepType::EMPTY:
-                break;
-            case StepType::DRIVE_MS:
-                left_drive.move(step.value1);
-                right_drive.move(step.value1);
-                pros::delay(step.value2);
-                stop_drive();
-                break;
-            case StepType::TANK_MS:
-                left_drive.move(step.value1);
-                right_drive.move(step.value2);
-                pros::delay(step.value3);
-                stop_drive();
-                break;
-            case StepType::TURN_HEADING:
-                turn_to_heading(step.value1, 60);
-                break;
-            case StepType::WAIT_MS:
-                pros::delay(step.value1);
-                break;
-            case StepType::INTAKE_ON:
-                intake_left.move(127);
-                intake_right.move(127);
-                break;
-            case StepType::INTAKE_OFF:
-                intake_left.brake();
-                intake_right.brake();
-                break;
-            case StepType::OUTTAKE_ON:
-                intake_left.move(-127);
-                intake_right.move(-127);
-                break;
-            case StepType::OUTTAKE_OFF:
-                intake_left.brake();
-                intake_right.brake();
-                break;
-        }
+    auton_steps::Hardware hw;
+    hw.drive = drive_tank;
+    hw.drive_stop = stop_drive;
+    hw.intake = intake_power;
+    hw.turn_tick = turn_toward_heading;
+    hw.condition = auton_condition;
+    auton_steps::Options options;
+    options.tick_ms = kAutonTickMs;
+    options.slew_per_tick = kAutonSlewPerTick;
+
+    std::vector<auton_steps::StepTiming> profile;
+    auton_steps::run_plan(plan, hw, options, &profile);
+
+    FILE* file = sd_manifest::open(kAutonProfileFile, "w");
+    if (file) {
+        auton_steps::write_profile(file, profile);
+        sd_manifest::close_written(file, kAutonProfileFile);
     }
 }
 
@@ -283,9 +262,6 @@ void run_plan(const std::vector<Step>& plan) {
 // SCREEN MENU (TOUCH UI)
 // =====================================================
 
-constexpr int kScreenW = 480;
-constexpr int kScreenH = 240;
-
 struct Rect {
     int x;
     int y;
@@ -297,64 +273,6 @@ bool hit_test(const Rect& r, int x, int y) {
     return x >= r.x && x <= (r.x + r.w) && y >= r.y && y <= (r.y + r.h);
 }
 
-const char* step_type_name(StepType type) {
-    switch (type) {
-        case StepType::EMPTY: return "EMPTY";
-        case StepType::DRIVE_MS: return "DRIVE_MS";
-        case StepType::TANK_MS: return "TANK_MS";
-        case StepType::TURN_HEADING: return "TURN_HEADING";
-        case StepType::WAIT_MS: return "WAIT_MS";
-        case StepType::INTAKE_ON: return "INTAKE_ON";
-        case StepType::INTAKE_OFF: return "INTAKE_OFF";
-        case StepType::OUTTAKE_ON: return "OUTTAKE_ON";
-        case StepType::OUTTAKE_OFF: return "OUTTAKE_OFF";
-        default: return "UNKNOWN";
-    }
-}
-
-StepType prev_step_type(StepType type) {
-    switch (type) {
-        case StepType::EMPTY: return StepType::OUTTAKE_OFF;
-        case StepType::DRIVE_MS: return StepType::EMPTY;
-        case StepType::TANK_MS: return StepType::DRIVE_MS;
-        case StepType::TURN_HEADING: return StepType::TANK_MS;
-        case StepType::WAIT_MS: return StepType::TURN_HEADING;
-        case StepType::INTAKE_ON: return StepType::WAIT_MS;
-        case StepType::INTAKE_OFF: return StepType::INTAKE_ON;
-        case StepType::OUTTAKE_ON: return StepType::INTAKE_OFF;
-        case StepType::OUTTAKE_OFF: return StepType::OUTTAKE_ON;
-        default: return StepType::DRIVE_MS;
-    }
-}
-
-StepType next_step_type(StepType type) {
-    switch (type) {
-        case StepType::EMPTY: return StepType::DRIVE_MS;
-        case StepType::DRIVE_MS: return StepType::TANK_MS;
-        case StepType::TANK_MS: return StepType::TURN_HEADING;
-        case StepType::TURN_HEADING: return StepType::WAIT_MS;
-        case StepType::WAIT_MS: return StepType::INTAKE_ON;
-        case StepType::INTAKE_ON: return StepType::INTAKE_OFF;
-        case StepType::INTAKE_OFF: return StepType::OUTTAKE_ON;
-        case StepType::OUTTAKE_ON: return StepType::OUTTAKE_OFF;
-        case StepType::OUTTAKE_OFF: return StepType::EMPTY;
-        default: return StepType::DRIVE_MS;
-    }
-}
-
-StepType parse_step_type(const std::string& token) {
-    if (token == "EMPTY") return StepType::EMPTY;
-    if (token == "DRIVE_MS") return StepType::DRIVE_MS;
-    if (token == "TANK_MS") return StepType::TANK_MS;
-    if (token == "TURN_HEADING") return StepType::TURN_HEADING;
-    if (token == "WAIT_MS") return StepType::WAIT_MS;
-    if (token == "INTAKE_ON") return StepType::INTAKE_ON;
-    if (token == "INTAKE_OFF") return StepType::INTAKE_OFF;
-    if (token == "OUTTAKE_ON") return StepType::OUTTAKE_ON;
-    if (token == "OUTTAKE_OFF") return StepType::OUTTAKE_OFF;
-    return StepType::EMPTY;
-}
-
 const char* slot_filename(int slot) {
     switch (slot) {
         case 0: return kSlot1File;
@@ -365,7 +283,7 @@ const char* slot_filename(int slot) {
 }
 
 int read_slot_file() {
-    FILE* file = sd_open("auton_slot.txt", "r");
+    FILE* file = sd_manifest::open("auton_slot.txt", "r");
     if (!file) {
         return 0;
     }
@@ -382,12 +300,12 @@ int read_slot_file() {
 }
 
 void write_slot_file(int slot) {
-    FILE* file = sd_open("auton_slot.txt", "w");
+    FILE* file = sd_manifest::open("auton_slot.txt", "w");
     if (!file) {
         return;
     }
     std::fprintf(file, "%d\n", slot + 1);
-    std::fclose(file);
+    sd_manifest::close_written(file, "auton_slot.txt");
 }
 
 std::vector<Step>& plan_for_mode(AutonMode mode) {
@@ -439,7 +357,7 @@ void clear_plan(std::vector<Step>& plan) {
 }
 
 bool load_plans_from_sd(const char* filename) {
-    FILE* file = sd_open(filename, "r");
+    FILE* file = sd_manifest::open(filename, "r");
     if (!file) {
         return false;
     }
@@ -466,13 +384,8 @@ bool load_plans_from_sd(const char* filename) {
             continue;
         }
 
-        char type_str[32];
-        int v1 = 0;
-        int v2 = 0;
-        int v3 = 0;
-        const int fields = std::sscanf(s.c_str(), "%31[^,],%d,%d,%d", type_str, &v1, &v2, &v3);
-        if (fields >= 3) {
-            Step step{parse_step_type(type_str), v1, v2, v3};
+        Step step{};
+        if (auton_steps::parse_step_line(s.c_str(), &step)) {
             if (section == Section::GPS) {
                 gps_plan.push_back(step);
             } else if (section == Section::BASIC) {
@@ -541,6 +454,35 @@ void draw_button(const Rect& r, const char* label, std::uint32_t color) {
     pros::screen::print(TEXT_MEDIUM, r.x + 6, r.y + 8, label);
 }
 
+// V1/V2/V3 button increments. Motion steps edit inches (degrees for the MOVE_TO_POSE
+// heading, the path number for FOLLOW_PATH) instead of speeds and milliseconds.
+int value_increment(StepType type, int field) {
+    if (!auton_steps::is_motion(type)) {
+        return field == 1 ? 5 : 50;
+    }
+    if (type == StepType::FOLLOW_PATH) {
+        return field == 1 ? 1 : 2;
+    }
+    return field == 3 ? 15 : 3;
+}
+
+// CHAIN presets for motion steps, {min speed, exit range}: the first stops on the target,
+// the others end the motion at speed so the next one carries on without stopping.
+constexpr std::uint8_t kChainPresets[][2] = {{0, 0}, {32, 2}, {64, 4}, {96, 6}};
+constexpr std::size_t kChainPresetCount = sizeof(kChainPresets) / sizeof(kChainPresets[0]);
+
+void next_chain_preset(Step& step) {
+    std::size_t next = 0;
+    for (std::size_t idx = 0; idx < kChainPresetCount; ++idx) {
+        if (step.min_speed == kChainPresets[idx][0] && step.exit_range == kChainPresets[idx][1]) {
+            next = (idx + 1) % kChainPresetCount;
+            break;
+        }
+    }
+    step.min_speed = kChainPresets[next][0];
+    step.exit_range = kChainPresets[next][1];
+}
+
 Rect record_button_rect() {
     return {10, 180, 140, 30};
 }
@@ -591,6 +533,8 @@ void draw_menu(AutonMode mode, int step_index, int slot) {
     const Rect v3m_btn{320, 140, 50, 30};
     const Rect v3p_btn{380, 140, 50, 30};
     const Rect clr_btn{170, 180, 140, 30};
+    const Rect lane_btn{320, 180, 110, 30};
+    const Rect chain_btn{320, 212, 110, 26};
 
     draw_button(prev_btn, "PREV", 0x00FFFFFF);
     draw_button(next_btn, "NEXT", 0x00FFFFFF);
@@ -603,14 +547,21 @@ void draw_menu(AutonMode mode, int step_index, int slot) {
     draw_button(v3p_btn, "V3+", 0x00FFFFFF);
     draw_record_button();
     draw_button(clr_btn, "CLEAR", 0x00FFFFFF);
-    pros::screen::print(TEXT_MEDIUM, 10, 120, "STEP: %d / %d", step_index + 1, count);
+    draw_button(lane_btn, "LANE", 0x00FFFFFF);
+    draw_button(chain_btn, "CHAIN", 0x00FFFFFF);
+    pros::screen::print(TEXT_MEDIUM, 10, 120, "STEP: %d / %d  LANE %u", step_index + 1, count,
+                        static_cast<unsigned>(step.lane));
     pros::screen::print(TEXT_MEDIUM, 10, 140, "TYPE: %s", step_type_name(step.type));
     pros::screen::print(TEXT_MEDIUM, 10, 160, "V1:%d  V2:%d  V3:%d", step.value1, step.value2, step.value3);
+    if (auton_steps::is_motion(step.type)) {
+        pros::screen::print(TEXT_MEDIUM, 10, 216, "MIN:%u EXIT:%u T:%dms", static_cast<unsigned>(step.min_speed),
+                            static_cast<unsigned>(step.exit_range), auton_steps::motion_timeout_ms(step));
+    }
     pros::screen::print(TEXT_MEDIUM, 10, 95, "SLOT: %d", slot + 1);
 }
 
 bool save_plans_to_sd(const char* filename) {
-    FILE* file = sd_open(filename, "w");
+    FILE* file = sd_manifest::open(filename, "w");
     if (!file) return false;
 
     g_plan_mutex.take();
@@ -624,14 +575,12 @@ bool save_plans_to_sd(const char* filename) {
         }
 
         if (last_non_empty < 0) {
-            std::fprintf(file, "%s,%d,%d,%d\n", step_type_name(kEmptyStep.type),
-                         kEmptyStep.value1, kEmptyStep.value2, kEmptyStep.value3);
+            auton_steps::write_step_line(file, kEmptyStep);
             return;
         }
 
         for (int i = 0; i <= last_non_empty; ++i) {
-            const Step& step = plan[i];
-            std::fprintf(file, "%s,%d,%d,%d\n", step_type_name(step.type), step.value1, step.value2, step.value3);
+            auton_steps::write_step_line(file, plan[i]);
         }
     };
 
@@ -642,7 +591,7 @@ bool save_plans_to_sd(const char* filename) {
     write_plan(basic_plan);
 
     g_plan_mutex.give();
-    std::fclose(file);
+    sd_manifest::close_written(file, filename);
     write_slot_file(g_save_slot);
     return true;
 }
@@ -687,6 +636,8 @@ void menu_loop() {
             const Rect v3p_btn{380, 140, 50, 30};
             const Rect rec_btn = record_button_rect();
             const Rect clr_btn{170, 180, 140, 30};
+            const Rect lane_btn{320, 180, 110, 30};
+            const Rect chain_btn{320, 212, 110, 26};
 
             if (hit_test(rec_btn, x, y)) {
                 if (g_recording) {
@@ -773,13 +724,18 @@ void menu_loop() {
                 step_index = std::min(step_index + 1, static_cast<int>(plan.size()) - 1);
             }
 
-            if (hit_test(type_btn, x, y)) plan[step_index].type = next_step_type(plan[step_index].type);
-            if (hit_test(v1m_btn, x, y)) plan[step_index].value1 -= 5;
-            if (hit_test(v1p_btn, x, y)) plan[step_index].value1 += 5;
-            if (hit_test(v2m_btn, x, y)) plan[step_index].value2 -= 50;
-            if (hit_test(v2p_btn, x, y)) plan[step_index].value2 += 50;
-            if (hit_test(v3m_btn, x, y)) plan[step_index].value3 -= 50;
-            if (hit_test(v3p_btn, x, y)) plan[step_index].value3 += 50;
+            Step& step = plan[step_index];
+            if (hit_test(type_btn, x, y)) step.type = next_step_type(step.type);
+            if (hit_test(v1m_btn, x, y)) step.value1 -= value_increment(step.type, 1);
+            if (hit_test(v1p_btn, x, y)) step.value1 += value_increment(step.type, 1);
+            if (hit_test(v2m_btn, x, y)) step.value2 -= value_increment(step.type, 2);
+            if (hit_test(v2p_btn, x, y)) step.value2 += value_increment(step.type, 2);
+            if (hit_test(v3m_btn, x, y)) step.value3 -= value_increment(step.type, 3);
+            if (hit_test(v3p_btn, x, y)) step.value3 += value_increment(step.type, 3);
+            if (hit_test(lane_btn, x, y)) {
+                step.lane = static_cast<std::uint8_t>((step.lane + 1) % auton_steps::kMaxLanes);
+            }
+            if (hit_test(chain_btn, x, y) && auton_steps::is_motion(step.type)) next_chain_preset(step);
             g_plan_mutex.give();
 
             draw_menu(g_auton_mode, step_index, g_save_slot);
@@ -799,12 +755,14 @@ void menu_task_fn(void*) {
 
 void initialize() {
     pros::lcd::initialize();
+    sd_manifest::probe_layout();
     imu.reset(true);
     while (imu.is_calibrating()) {
         pros::delay(10);
     }
     g_save_slot = read_slot_file();
     load_plans_from_sd(slot_filename(g_save_slot));
+    pros::lcd::print(2, "SD cache: %u probes saved", static_cast<unsigned>(sd_manifest::probes_saved()));
     static pros::Task menu_task(menu_task_fn, nullptr, TASK_PRIORITY_DEFAULT,
                                 TASK_STACK_DEPTH_DEFAULT, "AutonMenu");
 }
@@ -0,0 +1,191 @@
+#pragma once
+
+// Auton plan step engine shared by Tahera_Project and Auton_Planner_PROS.
+//
+// A plan is a list of Steps. Each StepType has one entry in a handler table (name used
+// in the plan files plus the function that runs it), so a new step type is one enum
+// value and one handler instead of an edit to every switch.
+//
+// Steps belong to a lane (0 unless the plan line says LANE=n). Lanes run side by side
+// off one scheduler and one clock: lane 0 can drive while lane 1 runs the intake for
+// 700 ms, and JOIN holds each lane until the others reach a JOIN or finish. Within a
+// lane the steps run in order on an absolute timeline: timed steps end at the previous
+// deadline plus their duration, consecutive drive steps hand their set-point to the next
+// one without braking, and every step's start, end and overrun are recorded.
+//
+// Only one lane drives at a time. A drive step (DRIVE_MS, TANK_MS, TURN_HEADING, and the
+// motion steps once a project registers them) takes the drive when it starts and gives
+// it back when it ends, unless the lane's next step drives too. A drive step in another
+// lane waits until the drive is free, then runs its full duration from that point.
+// Run::drive_left/drive_right belong to the lane holding the drive, so no lane brakes or
+// slews from another lane's set-point.
+//
+// Handlers never block. The scheduler calls a step's handler once to start it and then
+// once per tick until it reports DONE, sleeping with pros::Task::delay_until until the
+// next deadline or tick. Motors are reached only through the Hardware callbacks each
+// project fills in. The closed-loop motion steps (MOVE_TO_POINT and friends) need a pose
+// source, so they do nothing until a project registers handlers for them with
+// set_handler (Tahera runs them on the vendored LemLib motions).
+//
+// Built into each project by Auton_Steps/steps.mk.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace auton_steps {
+
+constexpr std::size_t kMaxLanes = 4;
+// Timeout of a motion step whose plan line has no TIMEOUT=.
+constexpr int kDefaultMotionTimeoutMs = 3000;
+
+// Order is the editor's cycle order and must match kStepNames in auton_steps.cpp.
+enum class StepType {
+    EMPTY,
+    DRIVE_MS,
+    TANK_MS,
+    TURN_HEADING,
+    WAIT_MS,
+    INTAKE_ON,
+    INTAKE_OFF,
+    OUTTAKE_ON,
+    OUTTAKE_OFF,
+    WAIT_UNTIL,  // value1 = ms after the plan started
+    WAIT_FOR,    // value1 = Condition, value2 = timeout ms (0 = none)
+    JOIN,
+    // Closed-loop motions on the odometry pose; x/y in inches from where the robot
+    // stood when the plan started, headings in compass degrees.
+    MOVE_TO_POINT,  // value1 = x, value2 = y
+    MOVE_TO_POSE,   // value1 = x, value2 = y, value3 = heading
+    TURN_TO_POINT,  // value1 = x, value2 = y
+    FOLLOW_PATH,    // value1 = path number (auton_path_N.txt), value2 = lookahead inches
+    COUNT
+};
+
+// WAIT_FOR conditions, answered by Hardware::condition.
+enum Condition {
+    kDriveStopped = 1,   // every drive motor below a few rpm
+    kIntakeStalled = 2,  // intake drawing current without turning
+};
+
+struct Step {
+    StepType type;
+    int value1;  // speed, heading or ms
+    int value2;  // duration for DRIVE_MS, right speed for TANK_MS
+    int value3;  // duration for TANK_MS
+    std::uint8_t lane = 0;
+    // Motion steps only (trailing TIMEOUT=, MIN= and EXIT= fields). A non-zero min_speed
+    // (0-127) lets the motion end at speed once it passes the target, less exit_range
+    // (inches, degrees for TURN_TO_POINT), so the next motion picks up without stopping.
+    std::uint16_t timeout_ms = 0;
+    std::uint8_t min_speed = 0;
+    std::uint8_t exit_range = 0;
+};
+
+struct Hardware {
+    void (*drive)(int left, int right) = nullptr;
+    void (*drive_stop)() = nullptr;
+    // +127 intake, -127 outtake, 0 brake.
+    void (*intake)(int power) = nullptr;
+    // One control update towards target; true once within tolerance (the engine brakes).
+    bool (*turn_tick)(double target, int max_speed) = nullptr;
+    // True when the Condition id holds; null makes WAIT_FOR wait for its timeout.
+    bool (*condition)(int id) = nullptr;
+    // Polled every tick; null when the plan can only end by running out.
+    bool (*should_abort)() = nullptr;
+};
+
+struct Options {
+    // Longest the scheduler sleeps before polling running steps and should_abort.
+    std::uint32_t tick_ms = 10;
+    // Largest drive command change per tick when one drive step hands over to the next.
+    // 0 switches set-points at once, which replays a recording exactly.
+    int slew_per_tick = 0;
+};
+
+// Times are microseconds from the start of run_plan(). overrun_us is how far the step
+// finished behind its lane's timeline (its deadline for timed steps).
+struct StepTiming {
+    StepType type = StepType::EMPTY;
+    std::uint16_t step = 0;  // index in the plan
+    std::uint8_t lane = 0;
+    std::uint32_t start_us = 0;
+    std::uint32_t end_us = 0;
+    std::int32_t overrun_us = 0;
+};
+
+enum class StepStatus { RUNNING, DONE, ABORT };
+
+struct Lane {
+    std::uint8_t id = 0;
+    std::size_t index = 0;          // plan index of the current step; plan size when done
+    bool started = false;           // the current step's handler has been called
+    bool polled = false;            // ... and returned RUNNING at least once
+    bool timed = false;             // deadline_ms ends the current step
+    bool at_join = false;
+    bool drive_wait = false;        // the current step is waiting for another lane's drive
+    std::uint32_t timeline_ms = 0;  // where the lane is on the pros::millis() clock
+    std::uint32_t deadline_ms = 0;
+    std::uint64_t step_start_us = 0;
+};
+
+// State of one run_plan() call, passed to every handler.
+struct Run {
+    const std::vector<Step>* plan = nullptr;
+    const Hardware* hw = nullptr;
+    Options options;
+    Lane lanes[kMaxLanes];
+    std::uint32_t start_ms = 0;
+    int drive_owner = -1;  // id of the lane holding the drive, -1 when free
+    int drive_left = 0;    // set-point carried between the owner's drive steps
+    int drive_right = 0;
+};
+
+// Called with lane.started == false to start the step, then every tick while it
+// returns RUNNING.
+using StepHandler = StepStatus (*)(Run& run, Lane& lane, const Step& step);
+
+// Plan file token for type ("DRIVE_MS"), and back; unknown tokens are EMPTY.
+const char* step_type_name(StepType type);
+StepType parse_step_type(const char* token);
+StepType next_step_type(StepType type);
+StepType prev_step_type(StepType type);
+
+// One plan line: "TYPE,v1,v2[,v3][,LANE=n][,TIMEOUT=ms][,MIN=n][,EXIT=n]". The named
+// fields trail the values so firmware that predates them still reads the line. False
+// for lines that are not steps.
+bool parse_step_line(const char* line, Step* out);
+// Writes step as a plan line; named fields only when they are not 0.
+void write_step_line(FILE* file, const Step& step);
+
+// Replaces the handler for type (e.g. a project-specific step).
+void set_handler(StepType type, StepHandler handler);
+
+// Helpers for handlers.
+// Starts a timed step ms after the lane's timeline; true once the deadline has passed.
+void start_timer(Lane& lane, int ms);
+bool timer_done(const Lane& lane);
+// Drives at left/right for ms, slewing from the carried set-point when slew_per_tick > 0
+// and braking at the end unless the lane's next step drives too.
+StepStatus drive_for(Run& run, Lane& lane, int left, int right, int ms);
+void drive_stop(Run& run);
+// True when the lane's next real step (EMPTY skipped) also drives, open or closed loop.
+bool next_step_drives(const Run& run, const Lane& lane);
+// True for the step types that need the drive (see the lane rule above).
+bool uses_drive(const Run& run, StepType type);
+bool is_motion(StepType type);
+// step.timeout_ms, or kDefaultMotionTimeoutMs when the plan line gave none.
+int motion_timeout_ms(const Step& step);
+
+// Runs every lane of plan to the end or until should_abort. profile (may be null) gets
+// one entry per finished step, in the order they finished. Returns false when aborted.
+bool run_plan(const std::vector<Step>& plan,
+              const Hardware& hw,
+              const Options& options,
+              std::vector<StepTiming>* profile);
+
+// "# step,lane,type,start_us,end_us,overrun_us" CSV plus a MAX_OVERRUN_US line.
+void write_profile(FILE* file, const std::vector<StepTiming>& profile);
+
+}  // namespace auton_steps
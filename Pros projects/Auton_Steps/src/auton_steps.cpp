@@ -0,0 +1,452 @@
+#include "auton_steps.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "api.h"
+
+namespace auton_steps {
+namespace {
+constexpr std::size_t kStepTypeCount = static_cast<std::size_t>(StepType::COUNT);
+
+constexpr const char* kStepNames[kStepTypeCount] = {
+    "EMPTY",         "DRIVE_MS",     "TANK_MS",       "TURN_HEADING", "WAIT_MS",  "INTAKE_ON",
+    "INTAKE_OFF",    "OUTTAKE_ON",   "OUTTAKE_OFF",   "WAIT_UNTIL",   "WAIT_FOR", "JOIN",
+    "MOVE_TO_POINT", "MOVE_TO_POSE", "TURN_TO_POINT", "FOLLOW_PATH",
+};
+
+int slew_toward(int current, int target, int max_step) {
+    if (max_step <= 0) {
+        return target;
+    }
+    return std::max(current - max_step, std::min(current + max_step, target));
+}
+
+// Wrap-safe "a is earlier than b" on the millisecond clock.
+bool before(std::uint32_t a, std::uint32_t b) {
+    return static_cast<std::int32_t>(a - b) < 0;
+}
+
+bool aborted(const Run& run) {
+    return run.hw->should_abort && run.hw->should_abort();
+}
+
+StepStatus run_empty(Run&, Lane&, const Step&) {
+    return StepStatus::DONE;
+}
+
+StepStatus run_drive_ms(Run& run, Lane& lane, const Step& step) {
+    return drive_for(run, lane, step.value1, step.value1, step.value2);
+}
+
+StepStatus run_tank_ms(Run& run, Lane& lane, const Step& step) {
+    return drive_for(run, lane, step.value1, step.value2, step.value3);
+}
+
+StepStatus run_turn_heading(Run& run, Lane&, const Step& step) {
+    if (run.hw->turn_tick && !run.hw->turn_tick(step.value1, 60)) {
+        return StepStatus::RUNNING;
+    }
+    drive_stop(run);
+    return StepStatus::DONE;
+}
+
+StepStatus run_wait_ms(Run&, Lane& lane, const Step& step) {
+    if (!lane.started) {
+        start_timer(lane, step.value1);
+    }
+    return timer_done(lane) ? StepStatus::DONE : StepStatus::RUNNING;
+}
+
+// Waits for a fixed point on the plan's clock, whatever the lane did before; a lane
+// already past it carries on at once.
+StepStatus run_wait_until(Run& run, Lane& lane, const Step& step) {
+    if (!lane.started) {
+        const std::uint32_t at_ms = run.start_ms + static_cast<std::uint32_t>(std::max(0, step.value1));
+        start_timer(lane, static_cast<std::int32_t>(at_ms - lane.timeline_ms));
+    }
+    return timer_done(lane) ? StepStatus::DONE : StepStatus::RUNNING;
+}
+
+StepStatus run_wait_for(Run& run, Lane& lane, const Step& step) {
+    if (!lane.started && step.value2 > 0) {
+        start_timer(lane, step.value2);
+    }
+    if (run.hw->condition && run.hw->condition(step.value1)) {
+        lane.timed = false;  // met early: the lane's timeline resumes from now
+        return StepStatus::DONE;
+    }
+    if (lane.timed) {
+        return timer_done(lane) ? StepStatus::DONE : StepStatus::RUNNING;
+    }
+    return run.hw->condition ? StepStatus::RUNNING : StepStatus::DONE;
+}
+
+StepStatus run_intake_on(Run& run, Lane&, const Step&) {
+    run.hw->intake(127);
+    return StepStatus::DONE;
+}
+
+StepStatus run_outtake_on(Run& run, Lane&, const Step&) {
+    run.hw->intake(-127);
+    return StepStatus::DONE;
+}
+
+StepStatus run_intake_off(Run& run, Lane&, const Step&) {
+    run.hw->intake(0);
+    return StepStatus::DONE;
+}
+
+// Parks the lane; run_plan() releases every parked lane together.
+StepStatus run_join(Run&, Lane& lane, const Step&) {
+    lane.at_join = true;
+    return StepStatus::RUNNING;
+}
+
+// Indexed by StepType. INTAKE_OFF and OUTTAKE_OFF both brake the intake; the motion
+// steps are skipped until a project with a pose source registers its own handlers.
+StepHandler g_handlers[kStepTypeCount] = {
+    run_empty,      run_drive_ms,   run_tank_ms,    run_turn_heading, run_wait_ms,  run_intake_on,
+    run_intake_off, run_outtake_on, run_intake_off, run_wait_until,   run_wait_for, run_join,
+    run_empty,      run_empty,      run_empty,      run_empty,
+};
+
+// Value of a trailing ",NAME=n" field, or 0 when the line has none.
+int named_field(const char* line, const char* name) {
+    char key[16];
+    std::snprintf(key, sizeof(key), ",%s=", name);
+    const char* field = std::strstr(line, key);
+    return field ? std::atoi(field + std::strlen(key)) : 0;
+}
+
+std::uint8_t clamp_u8(int value) {
+    return static_cast<std::uint8_t>(std::max(0, std::min(value, 255)));
+}
+
+std::size_t type_index(StepType type) {
+    const std::size_t index = static_cast<std::size_t>(type);
+    return index < kStepTypeCount ? index : 0;
+}
+
+std::size_t next_in_lane(const std::vector<Step>& plan, std::size_t from, std::uint8_t lane) {
+    while (from < plan.size() && plan[from].lane != lane) {
+        ++from;
+    }
+    return from;
+}
+
+bool lane_active(const Run& run, const Lane& lane) {
+    return lane.index < run.plan->size();
+}
+
+// Records the finished step, moves the lane's timeline to where the step ended on the
+// plan (its deadline, or now for steps that ended on a sensor) and starts the next one.
+void finish_step(Run& run, Lane& lane, std::uint64_t origin_us, std::vector<StepTiming>* profile) {
+    if (lane.timed) {
+        lane.timeline_ms = lane.deadline_ms;
+    } else if (lane.polled) {
+        lane.timeline_ms = pros::millis();
+    }
+    if (profile) {
+        const std::uint64_t end_us = pros::micros();
+        StepTiming timing;
+        timing.type = (*run.plan)[lane.index].type;
+        timing.step = static_cast<std::uint16_t>(lane.index);
+        timing.lane = lane.id;
+        timing.start_us = static_cast<std::uint32_t>(lane.step_start_us - origin_us);
+        timing.end_us = static_cast<std::uint32_t>(end_us - origin_us);
+        timing.overrun_us = static_cast<std::int32_t>(static_cast<std::int64_t>(end_us) -
+                                                      static_cast<std::int64_t>(lane.timeline_ms) * 1000);
+        profile->push_back(timing);
+    }
+    lane.index = next_in_lane(*run.plan, lane.index + 1, lane.id);
+    lane.started = false;
+    lane.polled = false;
+    lane.timed = false;
+    lane.at_join = false;
+}
+
+// Gives the drive to lane when it is free (or already the lane's). A lane that had to
+// wait starts its step from now rather than from a timeline the wait left behind.
+bool take_drive(Run& run, Lane& lane) {
+    if (run.drive_owner >= 0 && run.drive_owner != lane.id) {
+        lane.drive_wait = true;
+        return false;
+    }
+    run.drive_owner = lane.id;
+    if (lane.drive_wait) {
+        lane.drive_wait = false;
+        lane.timeline_ms = pros::millis();
+    }
+    return true;
+}
+
+// Runs the lane's steps until one is still in progress. False when a handler aborted.
+bool service_lane(Run& run, Lane& lane, std::uint64_t origin_us, std::vector<StepTiming>* profile) {
+    while (lane_active(run, lane)) {
+        const Step& step = (*run.plan)[lane.index];
+        const bool drives = uses_drive(run, step.type);
+        if (!lane.started) {
+            if (drives && !take_drive(run, lane)) {
+                return true;
+            }
+            lane.step_start_us = pros::micros();
+        }
+        const StepStatus status = g_handlers[type_index(step.type)](run, lane, step);
+        lane.started = true;
+        if (status == StepStatus::ABORT) {
+            return false;
+        }
+        if (status == StepStatus::RUNNING) {
+            lane.polled = true;
+            return true;
+        }
+        // Drive steps brake on the way out unless the lane drives next; either way the
+        // drive is only kept for that next step.
+        if (drives && !next_step_drives(run, lane)) {
+            run.drive_owner = -1;
+        }
+        finish_step(run, lane, origin_us, profile);
+    }
+    return true;
+}
+
+// Once every lane still running is parked on a JOIN, releases them all from the latest
+// timeline of any lane (a lane that finished last is what the others were waiting for).
+// True when lanes were released.
+bool release_join(Run& run, std::uint64_t origin_us, std::vector<StepTiming>* profile) {
+    bool parked = false;
+    std::uint32_t timeline_ms = run.start_ms;
+    for (const Lane& lane : run.lanes) {
+        if (before(timeline_ms, lane.timeline_ms)) {
+            timeline_ms = lane.timeline_ms;
+        }
+        if (!lane_active(run, lane)) {
+            continue;
+        }
+        if (!lane.at_join) {
+            return false;
+        }
+        parked = true;
+    }
+    if (!parked) {
+        return false;
+    }
+    for (Lane& lane : run.lanes) {
+        if (lane_active(run, lane)) {
+            lane.timeline_ms = timeline_ms;
+            lane.polled = false;
+            finish_step(run, lane, origin_us, profile);
+        }
+    }
+    return true;
+}
+}  // namespace
+
+const char* step_type_name(StepType type) {
+    return kStepNames[type_index(type)];
+}
+
+StepType parse_step_type(const char* token) {
+    for (std::size_t idx = 0; idx < kStepTypeCount; ++idx) {
+        if (std::strcmp(token, kStepNames[idx]) == 0) {
+            return static_cast<StepType>(idx);
+        }
+    }
+    return StepType::EMPTY;
+}
+
+StepType next_step_type(StepType type) {
+    return static_cast<StepType>((type_index(type) + 1) % kStepTypeCount);
+}
+
+StepType prev_step_type(StepType type) {
+    return static_cast<StepType>((type_index(type) + kStepTypeCount - 1) % kStepTypeCount);
+}
+
+bool parse_step_line(const char* line, Step* out) {
+    char type_str[32];
+    int v1 = 0;
+    int v2 = 0;
+    int v3 = 0;
+    if (std::sscanf(line, "%31[^,],%d,%d,%d", type_str, &v1, &v2, &v3) < 3) {
+        return false;
+    }
+    *out = Step{parse_step_type(type_str), v1, v2, v3};
+    const int lane = named_field(line, "LANE");
+    out->lane = static_cast<std::uint8_t>(std::max(0, std::min(lane, static_cast<int>(kMaxLanes) - 1)));
+    out->timeout_ms = static_cast<std::uint16_t>(std::max(0, std::min(named_field(line, "TIMEOUT"), 65535)));
+    out->min_speed = clamp_u8(std::min(named_field(line, "MIN"), 127));
+    out->exit_range = clamp_u8(named_field(line, "EXIT"));
+    return true;
+}
+
+void write_step_line(FILE* file, const Step& step) {
+    std::fprintf(file, "%s,%d,%d,%d", step_type_name(step.type), step.value1, step.value2, step.value3);
+    if (step.lane != 0) {
+        std::fprintf(file, ",LANE=%u", static_cast<unsigned>(step.lane));
+    }
+    if (step.timeout_ms != 0) {
+        std::fprintf(file, ",TIMEOUT=%u", static_cast<unsigned>(step.timeout_ms));
+    }
+    if (step.min_speed != 0) {
+        std::fprintf(file, ",MIN=%u", static_cast<unsigned>(step.min_speed));
+    }
+    if (step.exit_range != 0) {
+        std::fprintf(file, ",EXIT=%u", static_cast<unsigned>(step.exit_range));
+    }
+    std::fprintf(file, "\n");
+}
+
+void set_handler(StepType type, StepHandler handler) {
+    if (handler) {
+        g_handlers[type_index(type)] = handler;
+    }
+}
+
+void start_timer(Lane& lane, int ms) {
+    lane.deadline_ms = lane.timeline_ms + static_cast<std::uint32_t>(std::max(0, ms));
+    lane.timed = true;
+}
+
+bool timer_done(const Lane& lane) {
+    return !before(pros::millis(), lane.deadline_ms);
+}
+
+StepStatus drive_for(Run& run, Lane& lane, int left, int right, int ms) {
+    const bool starting = !lane.started;
+    if (starting) {
+        start_timer(lane, ms);
+    }
+    const int next_left = slew_toward(run.drive_left, left, run.options.slew_per_tick);
+    const int next_right = slew_toward(run.drive_right, right, run.options.slew_per_tick);
+    if (starting || next_left != run.drive_left || next_right != run.drive_right) {
+        run.drive_left = next_left;
+        run.drive_right = next_right;
+        run.hw->drive(run.drive_left, run.drive_right);
+    }
+    if (!timer_done(lane)) {
+        return StepStatus::RUNNING;
+    }
+    if (!next_step_drives(run, lane)) {
+        drive_stop(run);
+    }
+    return StepStatus::DONE;
+}
+
+void drive_stop(Run& run) {
+    run.hw->drive_stop();
+    run.drive_left = 0;
+    run.drive_right = 0;
+}
+
+bool next_step_drives(const Run& run, const Lane& lane) {
+    const std::vector<Step>& plan = *run.plan;
+    for (std::size_t next = next_in_lane(plan, lane.index + 1, lane.id); next < plan.size();
+         next = next_in_lane(plan, next + 1, lane.id)) {
+        if (plan[next].type != StepType::EMPTY) {
+            const StepType type = plan[next].type;
+            return type != StepType::TURN_HEADING && uses_drive(run, type);
+        }
+    }
+    return false;
+}
+
+bool uses_drive(const Run&, StepType type) {
+    // A motion step only takes the drive over when the project runs them.
+    return type == StepType::DRIVE_MS || type == StepType::TANK_MS || type == StepType::TURN_HEADING ||
+           (is_motion(type) && g_handlers[type_index(type)] != run_empty);
+}
+
+bool is_motion(StepType type) {
+    return type == StepType::MOVE_TO_POINT || type == StepType::MOVE_TO_POSE || type == StepType::TURN_TO_POINT ||
+           type == StepType::FOLLOW_PATH;
+}
+
+int motion_timeout_ms(const Step& step) {
+    return step.timeout_ms != 0 ? step.timeout_ms : kDefaultMotionTimeoutMs;
+}
+
+bool run_plan(const std::vector<Step>& plan,
+              const Hardware& hw,
+              const Options& options,
+              std::vector<StepTiming>* profile) {
+    Run run;
+    run.plan = &plan;
+    run.hw = &hw;
+    run.options = options;
+    run.options.tick_ms = std::max<std::uint32_t>(1, run.options.tick_ms);
+    run.start_ms = pros::millis();
+    const std::uint64_t origin_us = static_cast<std::uint64_t>(run.start_ms) * 1000;
+    for (std::size_t id = 0; id < kMaxLanes; ++id) {
+        Lane& lane = run.lanes[id];
+        lane.id = static_cast<std::uint8_t>(id);
+        lane.index = next_in_lane(plan, 0, lane.id);
+        lane.timeline_ms = run.start_ms;
+    }
+    if (profile) {
+        profile->clear();
+        profile->reserve(plan.size());
+    }
+
+    std::uint32_t wake_ms = run.start_ms;
+    bool ok = true;
+    while (ok) {
+        if (aborted(run)) {
+            ok = false;
+            break;
+        }
+        do {
+            for (Lane& lane : run.lanes) {
+                ok = service_lane(run, lane, origin_us, profile) && ok;
+            }
+        } while (ok && release_join(run, origin_us, profile));
+
+        // Sleep to the next tick, or to an earlier step deadline so timed steps end on time.
+        bool active = false;
+        std::uint32_t next_ms = wake_ms + run.options.tick_ms;
+        for (const Lane& lane : run.lanes) {
+            if (!lane_active(run, lane)) {
+                continue;
+            }
+            active = true;
+            if (lane.timed && before(lane.deadline_ms, next_ms)) {
+                next_ms = lane.deadline_ms;
+            }
+        }
+        if (!ok || !active) {
+            break;
+        }
+        const std::uint32_t now_ms = pros::millis();
+        if (before(next_ms, now_ms)) {
+            wake_ms = now_ms;  // a slow handler put us behind: poll again now, don't replay ticks
+            continue;
+        }
+        pros::Task::delay_until(&wake_ms, next_ms - wake_ms);
+    }
+
+    if (!ok) {
+        drive_stop(run);
+        hw.intake(0);
+    }
+    return ok;
+}
+
+void write_profile(FILE* file, const std::vector<StepTiming>& profile) {
+    if (!file) {
+        return;
+    }
+    std::int32_t max_overrun = 0;
+    std::fprintf(file, "# step,lane,type,start_us,end_us,overrun_us\n");
+    for (const StepTiming& timing : profile) {
+        std::fprintf(file, "%u,%u,%s,%u,%u,%ld\n", static_cast<unsigned>(timing.step),
+                     static_cast<unsigned>(timing.lane), step_type_name(timing.type),
+                     static_cast<unsigned>(timing.start_us), static_cast<unsigned>(timing.end_us),
+                     static_cast<long>(timing.overrun_us));
+        max_overrun = std::max(max_overrun, timing.overrun_us);
+    }
+    std::fprintf(file, "MAX_OVERRUN_US : %ld\n", static_cast<long>(max_overrun));
+}
+
+}  // namespace auton_steps
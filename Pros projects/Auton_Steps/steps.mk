@@ -0,0 +1,13 @@
+# Shared auton step engine (Auton_Steps). Included from the Makefile of every project
+# that runs plan files: adds the header path and links the engine objects into the hot
+# image alongside the project's own src/ objects.
+STEPS_DIR:=$(ROOT)/../Auton_Steps
+STEPS_SRC:=$(wildcard $(STEPS_DIR)/src/*.cpp)
+STEPS_OBJ:=$(patsubst $(STEPS_DIR)/src/%,$(BINDIR)/steps/%.o,$(STEPS_SRC))
+
+EXTRA_INCDIR+=$(STEPS_DIR)/include
+ELF_DEPS+=$(STEPS_OBJ)
+
+$(BINDIR)/steps/%.cpp.o: $(STEPS_DIR)/src/%.cpp $(wildcard $(STEPS_DIR)/include/*.hpp)
+	$(VV)mkdir -p $(dir $@)
+	$(call test_output_2,Compiled $< ,$(CXX) -c $(INCLUDE) $(CXXFLAGS) $(EXTRA_CXXFLAGS) -o $@ $<,$(OK_STRING))
@@ -0,0 +1,107 @@
+#pragma once
+
+// Drive recorder shared by Tahera_Project and Basic_Bonkers_PROS.
+//
+// The control loop pushes one Frame per tick (lock-free, never touches the SD card).
+// A low-priority writer task drains the queue into a preallocated block, runs it
+// through the text or binary encoder, and writes each block as one checksummed
+// segment. tools/bonkers_record_decode.py and the replay apps read both formats.
+//
+// Built into each project by Bonkers_Recorder/recorder.mk.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "api.h"
+
+namespace recorder {
+
+enum class Format {
+    TEXT = 0,
+    BINARY
+};
+
+// Stored in the binary header so the decoder can pick the matching button table.
+enum class Program : std::uint8_t {
+    TAHERA = 0,
+    BASIC_BONKERS = 1
+};
+
+// record_config.txt (KEY=VALUE, case-insensitive):
+//   FORMAT=TEXT|BINARY  DELTA=ON  DEADBAND=N  TELEMETRY_MS=N
+struct Config {
+    Format format = Format::TEXT;
+    bool delta = false;
+    int deadband = 0;
+    std::uint32_t telemetry_ms = 0;  // 0 = telemetry track off
+};
+
+constexpr char kConfigName[] = "record_config.txt";
+constexpr char kLogName[] = "bonkers_log_";
+constexpr std::uint8_t kNoDriveMode = 0xFF;
+constexpr std::size_t kMaxTelemetryMotors = 8;
+
+// Type/value pair written for a set button bit, indexed by bit position.
+struct ButtonName {
+    const char* type;
+    const char* value;
+};
+
+struct Session {
+    Program program = Program::TAHERA;
+    const char* program_name = "TAHERA";       // REC_START value
+    std::uint8_t drive_mode = kNoDriveMode;    // written to the binary header
+    const char* drive_mode_name = nullptr;     // DRIVE_MODE line, skipped when null
+    const ButtonName* buttons = nullptr;       // up to 16 entries
+    std::size_t button_count = 0;
+    const char* const* motor_names = nullptr;  // TELEM columns, by MOTOR index
+};
+
+enum MotorFlag : std::uint8_t {
+    kMotorOverTemp = 1u << 0,
+    kMotorOverCurrent = 1u << 1
+};
+
+// Groups report mean velocity, first-motor position, summed current and hottest motor.
+struct __attribute__((packed)) MotorSample {
+    std::uint8_t tag;
+    std::uint8_t index;
+    std::int16_t velocity_rpm;
+    std::int32_t position_deg;
+    std::uint16_t current_ma;
+    std::uint8_t temperature_c;
+    std::uint8_t flags;
+};
+
+// Parses one record_config.txt line into config; unknown keys are ignored.
+void parse_config_line(const char* line, Config* config);
+Config load_config(FILE* file);
+void set_config(const Config& config);
+const Config& config();
+
+// Path for a new recording in the configured format.
+std::string make_log_path();
+
+bool start(const char* path, const Session& session);
+void stop(const char* reason);
+bool is_recording();
+void status(bool* active, std::string* path, std::uint32_t* overruns = nullptr,
+            std::uint32_t* telemetry_drops = nullptr);
+
+// Control-loop side. push_frame stamps dt_us from pros::micros(); a full queue drops
+// the frame and counts an overrun. push_telemetry counts the samples it drops the same
+// way; both totals are written before REC_STOP.
+void push_frame(const int axes[4], std::uint16_t buttons);
+bool telemetry_due();
+void push_telemetry(double heading_deg, const MotorSample* motors, std::size_t count);
+MotorSample sample_motor(const pros::AbstractMotor& motor, std::uint8_t index);
+
+// Creates the background writer (once).
+void start_writer_task(std::uint32_t priority, const char* name);
+
+// Boot-time repair of recordings left open by a brownout. Returns files repaired.
+int recover_logs();
+
+}  // namespace recorder
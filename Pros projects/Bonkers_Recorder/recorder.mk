@@ -0,0 +1,16 @@
+# Shared drive recorder (Bonkers_Recorder). Included from the Makefile of every
+# project that records: adds the header path and links the recorder objects into
+# the hot image alongside the project's own src/ objects. Pulls in SD_Manifest, which
+# the recorder updates as it writes and repairs logs.
+include $(ROOT)/../SD_Manifest/manifest.mk
+
+RECORDER_DIR:=$(ROOT)/../Bonkers_Recorder
+RECORDER_SRC:=$(wildcard $(RECORDER_DIR)/src/*.cpp)
+RECORDER_OBJ:=$(patsubst $(RECORDER_DIR)/src/%,$(BINDIR)/recorder/%.o,$(RECORDER_SRC))
+
+EXTRA_INCDIR+=$(RECORDER_DIR)/include
+ELF_DEPS+=$(RECORDER_OBJ)
+
+$(BINDIR)/recorder/%.cpp.o: $(RECORDER_DIR)/src/%.cpp $(wildcard $(RECORDER_DIR)/include/*.hpp)
+	$(VV)mkdir -p $(dir $@)
+	$(call test_output_2,Compiled $< ,$(CXX) -c $(INCLUDE) $(CXXFLAGS) $(EXTRA_CXXFLAGS) -o $@ $<,$(OK_STRING))
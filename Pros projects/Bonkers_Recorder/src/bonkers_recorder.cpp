@@ -0,0 +1,1083 @@
+#include "bonkers_recorder.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "sd_manifest.hpp"
+
+namespace recorder {
+namespace {
+constexpr char kLogDir[] = "/usd/";
+constexpr char kRecoveredReason[] = "RECOVERED";
+constexpr std::uint32_t kRingFrames = 256;
+constexpr std::uint32_t kWriteBatchFrames = 50;
+constexpr std::uint32_t kWriterPeriodMs = 100;
+constexpr std::uint32_t kMaxLatencyMs = 1000;
+constexpr std::size_t kBlockBytes = 8192;
+constexpr std::size_t kCheckpointBytes = 64;  // room always kept for the closing checkpoint
+constexpr std::uint32_t kTelemetryRingSamples = 32;
+constexpr std::uint32_t kTelemetryMinPeriodMs = 20;
+constexpr std::uint32_t kLoopStatBinUs = 100;
+constexpr std::uint32_t kLoopStatBins = 512;
+// Boot-time recovery reads logs this much at a time (a whole number of binary records).
+constexpr std::size_t kScanChunkBytes = 341 * 12;
+constexpr std::size_t kMaxTextLine = 512;
+// Where recovery copies the good part of a torn log before writing it back (FAT on the
+// brain has no truncate).
+constexpr char kRecoverScratchPath[] = "/usd/bonkers_recover.tmp";
+
+// Binary recordings are a BinHeader followed by fixed 12-byte records, each starting
+// with its tag.
+constexpr char kBinMagic[4] = {'B', 'N', 'K', 'R'};
+constexpr std::uint16_t kBinVersion = 5;
+
+enum class Tag : std::uint8_t {
+    FRAME = 1,
+    STOP = 2,
+    OVERRUN = 3,
+    REPEAT = 4,
+    STATS = 5,
+    CHECKPOINT = 6,
+    TELEMETRY = 7,
+    MOTOR = 8,
+    TELEMETRY_DROP = 9
+};
+
+struct __attribute__((packed)) BinHeader {
+    char magic[4];
+    std::uint16_t version;
+    std::uint16_t record_size;
+    std::uint8_t drive_mode;
+    std::uint8_t program;
+    std::uint8_t reserved[2];
+};
+
+struct __attribute__((packed)) Frame {
+    std::uint8_t tag;
+    std::uint8_t reserved;
+    std::uint16_t buttons;
+    std::uint32_t dt_us;
+    std::int8_t axis[4];
+};
+
+struct __attribute__((packed)) BinStop {
+    std::uint8_t tag;
+    char reason[11];
+};
+
+struct __attribute__((packed)) BinCount {
+    std::uint8_t tag;
+    std::uint8_t reserved[3];
+    std::uint32_t count;
+    std::uint32_t total_us;  // REPEAT: summed dt_us of the folded ticks; 0 otherwise
+};
+
+// Loop-period summary written before REC_STOP, in 10 us units.
+struct __attribute__((packed)) BinStats {
+    std::uint8_t tag;
+    std::uint8_t reserved;
+    std::uint16_t min_10us;
+    std::uint16_t max_10us;
+    std::uint16_t mean_10us;
+    std::uint16_t p99_10us;
+    std::uint8_t reserved2[2];
+};
+
+// Closes a segment: every byte since the previous checkpoint (or the start of the file)
+// is covered by crc32, so recovery can cut a torn file back to the last good segment.
+struct __attribute__((packed)) BinCheckpoint {
+    std::uint8_t tag;
+    std::uint8_t reserved;
+    std::uint16_t segment;
+    std::uint32_t length;
+    std::uint32_t crc32;
+};
+
+// Telemetry tick: one TELEMETRY record followed by motor_count MOTOR records.
+struct __attribute__((packed)) BinTelemetry {
+    std::uint8_t tag;
+    std::uint8_t motor_count;
+    std::uint16_t heading_centideg;
+    std::uint32_t time_ms;
+    std::uint8_t reserved[4];
+};
+
+static_assert(sizeof(BinHeader) == 12, "binary record header must stay 12 bytes");
+static_assert(sizeof(Frame) == 12, "binary frame must stay 12 bytes");
+static_assert(sizeof(BinStop) == sizeof(Frame), "binary records are fixed width");
+static_assert(sizeof(BinCount) == sizeof(Frame), "binary records are fixed width");
+static_assert(sizeof(BinStats) == sizeof(Frame), "binary records are fixed width");
+static_assert(sizeof(BinCheckpoint) == sizeof(Frame), "binary records are fixed width");
+static_assert(sizeof(BinTelemetry) == sizeof(Frame), "binary records are fixed width");
+static_assert(sizeof(MotorSample) == sizeof(Frame), "binary records are fixed width");
+
+// Single-producer/single-consumer frame queue. push_frame (control task) is the only
+// producer; consumers only pop while holding g_mutex, so the control loop never blocks
+// on the mutex or the SD card.
+struct FrameRing {
+    Frame frames[kRingFrames];
+    std::atomic<std::uint32_t> head{0};
+    std::atomic<std::uint32_t> tail{0};
+    std::atomic<std::uint32_t> overruns{0};
+};
+
+struct TelemetrySample {
+    std::uint32_t after_frame;  // frame ring head when sampled; written before that frame
+    std::uint32_t time_ms;
+    std::uint16_t heading_centideg;
+    std::uint8_t motor_count;
+    MotorSample motors[kMaxTelemetryMotors];
+};
+
+// Same single-producer contract as FrameRing, filled at the TELEMETRY_MS rate.
+struct TelemetryRing {
+    TelemetrySample samples[kTelemetryRingSamples];
+    std::atomic<std::uint32_t> head{0};
+    std::atomic<std::uint32_t> tail{0};
+    std::atomic<std::uint32_t> drops{0};
+};
+
+// Control-loop period histogram (100 us bins, last bin catches everything slower),
+// accumulated by the writer from each frame's dt_us.
+struct LoopStats {
+    std::uint32_t count = 0;
+    std::uint32_t min_us = 0xFFFFFFFFu;
+    std::uint32_t max_us = 0;
+    std::uint64_t total_us = 0;
+    std::uint32_t bins[kLoopStatBins] = {};
+};
+
+struct RecordScan {
+    std::size_t valid_end = 0;  // bytes up to and including the last good checkpoint
+    std::uint32_t segments = 0;
+    bool stopped = false;       // the last good segment carries REC_STOP
+};
+
+Config g_config;
+Session g_session;
+std::atomic<bool> g_recording{false};
+FILE* g_file = nullptr;
+std::string g_path;
+std::uint8_t g_block[kBlockBytes];
+std::size_t g_block_used = 0;
+std::uint32_t g_last_write_ms = 0;
+std::uint32_t g_segment = 0;
+std::uint64_t g_last_us = 0;
+std::uint32_t g_telemetry_last_ms = 0;
+FrameRing g_ring;
+TelemetryRing g_telemetry_ring;
+LoopStats g_loop_stats;
+pros::Mutex g_mutex;
+
+// Delta mode (consumer side): frames within the deadband of the last written frame and
+// with no button edges are folded into a single "repeat N ticks" record that also keeps
+// their summed dt_us, so replays keep the measured timing.
+Frame g_last_frame{};
+bool g_have_last = false;
+std::uint32_t g_repeat = 0;
+std::uint32_t g_repeat_us = 0;
+
+std::string trim_upper(const char* text) {
+    std::string value(text ? text : "");
+    std::size_t start = 0;
+    while (start < value.size() && std::isspace(static_cast<unsigned char>(value[start]))) {
+        ++start;
+    }
+    std::size_t end = value.size();
+    while (end > start && std::isspace(static_cast<unsigned char>(value[end - 1]))) {
+        --end;
+    }
+    value = value.substr(start, end - start);
+    for (char& ch : value) {
+        ch = static_cast<char>(std::toupper(static_cast<unsigned char>(ch)));
+    }
+    return value;
+}
+
+bool starts_with(const char* str, const char* prefix) {
+    return std::strncmp(str, prefix, std::strlen(prefix)) == 0;
+}
+
+// Standard reflected CRC-32 (zlib/binascii compatible), nibble table. crc32_update
+// carries the running (uninverted) value so a segment can be checked across reads.
+constexpr std::uint32_t kCrcInit = 0xFFFFFFFFu;
+
+std::uint32_t crc32_update(std::uint32_t crc, const std::uint8_t* data, std::size_t size) {
+    static constexpr std::uint32_t kTable[16] = {
+        0x00000000u, 0x1DB71064u, 0x3B6E20C8u, 0x26D930ACu, 0x76DC4190u, 0x6B6B51F4u,
+        0x4DB26158u, 0x5005713Cu, 0xEDB88320u, 0xF00F9344u, 0xD6D6A3E8u, 0xCB61B38Cu,
+        0x9B64C2B0u, 0x86D3D2D4u, 0xA00AE278u, 0xBDBDF21Cu,
+    };
+    for (std::size_t idx = 0; idx < size; ++idx) {
+        crc = kTable[(crc ^ data[idx]) & 0x0F] ^ (crc >> 4);
+        crc = kTable[(crc ^ (data[idx] >> 4)) & 0x0F] ^ (crc >> 4);
+    }
+    return crc;
+}
+
+std::uint32_t crc32(const std::uint8_t* data, std::size_t size) {
+    return ~crc32_update(kCrcInit, data, size);
+}
+
+// Writes the checkpoint closing buf[seg_start..used) at buf + used (kCheckpointBytes
+// must be free) and returns the new used size.
+std::size_t append_checkpoint(std::uint8_t* buf,
+                              std::size_t seg_start,
+                              std::size_t used,
+                              Format format,
+                              std::uint32_t segment) {
+    const std::uint32_t length = static_cast<std::uint32_t>(used - seg_start);
+    const std::uint32_t crc = crc32(buf + seg_start, length);
+    if (format == Format::BINARY) {
+        BinCheckpoint record{};
+        record.tag = static_cast<std::uint8_t>(Tag::CHECKPOINT);
+        record.segment = static_cast<std::uint16_t>(segment);
+        record.length = length;
+        record.crc32 = crc;
+        std::memcpy(buf + used, &record, sizeof(record));
+        return used + sizeof(record);
+    }
+    const int written = std::snprintf(reinterpret_cast<char*>(buf + used), kCheckpointBytes,
+                                      "CHECKPOINT : %u %u %08X\n",
+                                      static_cast<unsigned>(segment),
+                                      static_cast<unsigned>(length),
+                                      static_cast<unsigned>(crc));
+    return used + static_cast<std::size_t>(std::max(0, written));
+}
+
+// Each non-empty flush is one segment terminated by a checkpoint, so a brownout can
+// lose at most the segment being written.
+void flush_locked() {
+    if (!g_file) {
+        return;
+    }
+    if (g_block_used > 0) {
+        g_block_used = append_checkpoint(g_block, 0, g_block_used, g_config.format, g_segment);
+        ++g_segment;
+        std::fwrite(g_block, 1, g_block_used, g_file);
+        g_block_used = 0;
+    }
+    std::fflush(g_file);
+    g_last_write_ms = pros::millis();
+}
+
+void append_locked(const void* data, std::size_t size) {
+    if (g_block_used + size + kCheckpointBytes > kBlockBytes) {
+        flush_locked();
+    }
+    std::memcpy(g_block + g_block_used, data, size);
+    g_block_used += size;
+}
+
+// Text encoder: one "TYPE : VALUE" line.
+void append_line_locked(const char* type, const char* value) {
+    char row[96];
+    const int written = std::snprintf(row, sizeof(row), "%s : %s\n", type, value);
+    if (written > 0) {
+        append_locked(row, std::min(static_cast<std::size_t>(written), sizeof(row) - 1));
+    }
+}
+
+void append_line_locked(const char* type, int value) {
+    char text[16];
+    std::snprintf(text, sizeof(text), "%d", value);
+    append_line_locked(type, text);
+}
+
+void append_count_locked(Tag tag, std::uint32_t count, std::uint32_t total_us = 0) {
+    BinCount record{};
+    record.tag = static_cast<std::uint8_t>(tag);
+    record.count = count;
+    record.total_us = total_us;
+    append_locked(&record, sizeof(record));
+}
+
+void append_stop_locked(const char* reason) {
+    if (g_config.format == Format::BINARY) {
+        BinStop stop{};
+        stop.tag = static_cast<std::uint8_t>(Tag::STOP);
+        std::strncpy(stop.reason, reason, sizeof(stop.reason));
+        append_locked(&stop, sizeof(stop));
+    } else {
+        append_line_locked("REC_STOP", reason);
+    }
+}
+
+void loop_stats_add(LoopStats& stats, std::uint32_t period_us) {
+    ++stats.count;
+    stats.min_us = std::min(stats.min_us, period_us);
+    stats.max_us = std::max(stats.max_us, period_us);
+    stats.total_us += period_us;
+    stats.bins[std::min(period_us / kLoopStatBinUs, kLoopStatBins - 1)] += 1;
+}
+
+std::uint32_t loop_stats_mean(const LoopStats& stats) {
+    return stats.count == 0 ? 0 : static_cast<std::uint32_t>(stats.total_us / stats.count);
+}
+
+// Upper edge of the bin holding the 99th percentile, clamped to the observed max.
+std::uint32_t loop_stats_p99(const LoopStats& stats) {
+    if (stats.count == 0) {
+        return 0;
+    }
+    const std::uint32_t target = stats.count - stats.count / 100;
+    std::uint32_t seen = 0;
+    for (std::uint32_t bin = 0; bin < kLoopStatBins; ++bin) {
+        seen += stats.bins[bin];
+        if (seen >= target) {
+            return std::min((bin + 1) * kLoopStatBinUs, stats.max_us);
+        }
+    }
+    return stats.max_us;
+}
+
+void write_loop_stats_locked() {
+    const LoopStats& stats = g_loop_stats;
+    if (stats.count == 0) {
+        return;
+    }
+    if (g_config.format == Format::BINARY) {
+        const auto to_10us = [](std::uint32_t us) {
+            return static_cast<std::uint16_t>(std::min<std::uint32_t>(us / 10, 0xFFFF));
+        };
+        BinStats record{};
+        record.tag = static_cast<std::uint8_t>(Tag::STATS);
+        record.min_10us = to_10us(stats.min_us);
+        record.max_10us = to_10us(stats.max_us);
+        record.mean_10us = to_10us(loop_stats_mean(stats));
+        record.p99_10us = to_10us(loop_stats_p99(stats));
+        append_locked(&record, sizeof(record));
+        return;
+    }
+    append_line_locked("LOOP_MIN_US", static_cast<int>(stats.min_us));
+    append_line_locked("LOOP_MAX_US", static_cast<int>(stats.max_us));
+    append_line_locked("LOOP_MEAN_US", static_cast<int>(loop_stats_mean(stats)));
+    append_line_locked("LOOP_P99_US", static_cast<int>(loop_stats_p99(stats)));
+}
+
+bool axes_changed(const Frame& a, const Frame& b) {
+    for (int idx = 0; idx < 4; ++idx) {
+        if (std::abs(static_cast<int>(a.axis[idx]) - static_cast<int>(b.axis[idx])) > g_config.deadband) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void flush_repeat_locked() {
+    if (g_repeat == 0) {
+        return;
+    }
+    if (g_config.format == Format::BINARY) {
+        append_count_locked(Tag::REPEAT, g_repeat, g_repeat_us);
+    } else {
+        char text[24];
+        std::snprintf(text, sizeof(text), "%lu %lu", static_cast<unsigned long>(g_repeat),
+                      static_cast<unsigned long>(g_repeat_us));
+        append_line_locked("REPEAT", text);
+    }
+    g_repeat = 0;
+    g_repeat_us = 0;
+}
+
+void encode_frame_locked(const Frame& frame) {
+    if (frame.dt_us > 0) {
+        loop_stats_add(g_loop_stats, frame.dt_us);
+    }
+
+    if (g_config.delta) {
+        if (g_have_last && frame.buttons == 0 && !axes_changed(g_last_frame, frame)) {
+            ++g_repeat;
+            g_repeat_us += frame.dt_us;
+            return;
+        }
+        flush_repeat_locked();
+        g_last_frame = frame;
+        g_have_last = true;
+    }
+
+    if (g_config.format == Format::BINARY) {
+        append_locked(&frame, sizeof(frame));
+        return;
+    }
+
+    append_line_locked("DT_US", static_cast<int>(frame.dt_us));
+    append_line_locked("AXIS1", frame.axis[0]);
+    append_line_locked("AXIS2", frame.axis[1]);
+    append_line_locked("AXIS3", frame.axis[2]);
+    append_line_locked("AXIS4", frame.axis[3]);
+    for (std::size_t bit = 0; bit < g_session.button_count && bit < 16; ++bit) {
+        if (frame.buttons & (1u << bit)) {
+            append_line_locked(g_session.buttons[bit].type, g_session.buttons[bit].value);
+        }
+    }
+}
+
+void encode_telemetry_locked(const TelemetrySample& sample) {
+    if (g_config.format == Format::BINARY) {
+        BinTelemetry record{};
+        record.tag = static_cast<std::uint8_t>(Tag::TELEMETRY);
+        record.motor_count = sample.motor_count;
+        record.heading_centideg = sample.heading_centideg;
+        record.time_ms = sample.time_ms;
+        append_locked(&record, sizeof(record));
+        for (std::size_t idx = 0; idx < sample.motor_count; ++idx) {
+            append_locked(&sample.motors[idx], sizeof(MotorSample));
+        }
+        return;
+    }
+
+    // TELEM : <ms> H=<deg> <name>=<rpm>,<deg>,<mA>,<C>[,!T][,!I] ...
+    char row[384];
+    int used = std::snprintf(row, sizeof(row), "TELEM : %u H=%u.%02u",
+                             static_cast<unsigned>(sample.time_ms),
+                             static_cast<unsigned>(sample.heading_centideg / 100),
+                             static_cast<unsigned>(sample.heading_centideg % 100));
+    for (std::size_t idx = 0; idx < sample.motor_count && used > 0 && used < static_cast<int>(sizeof(row)); ++idx) {
+        const MotorSample& motor = sample.motors[idx];
+        char fallback[8];
+        const char* name = g_session.motor_names ? g_session.motor_names[motor.index] : nullptr;
+        if (!name) {
+            std::snprintf(fallback, sizeof(fallback), "M%u", static_cast<unsigned>(motor.index));
+            name = fallback;
+        }
+        used += std::snprintf(row + used, sizeof(row) - used, " %s=%d,%ld,%u,%u%s%s",
+                              name,
+                              static_cast<int>(motor.velocity_rpm),
+                              static_cast<long>(motor.position_deg),
+                              static_cast<unsigned>(motor.current_ma),
+                              static_cast<unsigned>(motor.temperature_c),
+                              (motor.flags & kMotorOverTemp) ? ",!T" : "",
+                              (motor.flags & kMotorOverCurrent) ? ",!I" : "");
+    }
+    if (used > 0 && used < static_cast<int>(sizeof(row)) - 1) {
+        row[used++] = '\n';
+        append_locked(row, static_cast<std::size_t>(used));
+    }
+}
+
+bool ring_pop_locked(Frame* out) {
+    const std::uint32_t tail = g_ring.tail.load(std::memory_order_relaxed);
+    const std::uint32_t head = g_ring.head.load(std::memory_order_acquire);
+    if (tail == head) {
+        return false;
+    }
+    *out = g_ring.frames[tail % kRingFrames];
+    g_ring.tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+std::uint32_t ring_size() {
+    return g_ring.head.load(std::memory_order_acquire) - g_ring.tail.load(std::memory_order_acquire);
+}
+
+// Writes queued telemetry taken before frame number frame_index (all of it if
+// drain_all), keeping the track interleaved with the frames it was sampled next to.
+void drain_telemetry_locked(std::uint32_t frame_index, bool drain_all) {
+    TelemetryRing& ring = g_telemetry_ring;
+    while (true) {
+        const std::uint32_t tail = ring.tail.load(std::memory_order_relaxed);
+        if (tail == ring.head.load(std::memory_order_acquire)) {
+            return;
+        }
+        const TelemetrySample& sample = ring.samples[tail % kTelemetryRingSamples];
+        if (!drain_all && static_cast<std::int32_t>(sample.after_frame - frame_index) > 0) {
+            return;
+        }
+        encode_telemetry_locked(sample);
+        ring.tail.store(tail + 1, std::memory_order_release);
+    }
+}
+
+// Moves every queued frame and telemetry sample through the encoder into g_block.
+void drain_locked() {
+    Frame frame{};
+    while (true) {
+        drain_telemetry_locked(g_ring.tail.load(std::memory_order_relaxed), false);
+        if (!ring_pop_locked(&frame)) {
+            break;
+        }
+        encode_frame_locked(frame);
+    }
+    drain_telemetry_locked(0, true);
+}
+
+// Low-priority consumer: drains the queues to SD in large blocks.
+void writer_task_fn(void*) {
+    while (true) {
+        pros::delay(kWriterPeriodMs);
+        if (!g_recording) {
+            continue;
+        }
+        const bool batch_ready = ring_size() >= kWriteBatchFrames;
+        const bool stale = (pros::millis() - g_last_write_ms) >= kMaxLatencyMs;
+        if (!batch_ready && !stale) {
+            continue;
+        }
+        g_mutex.take();
+        if (g_recording && g_file) {
+            drain_locked();
+            flush_locked();
+        }
+        g_mutex.give();
+    }
+}
+
+bool valid_bin_header(const std::uint8_t* data) {
+    BinHeader header{};
+    std::memcpy(&header, data, sizeof(header));
+    return std::memcmp(header.magic, kBinMagic, sizeof(header.magic)) == 0 && header.version >= 3 &&
+           header.record_size == sizeof(Frame);
+}
+
+// True when the recording ends with a good checkpoint whose segment carries REC_STOP,
+// i.e. it was closed normally. A segment never exceeds one block, so only the last
+// kBlockBytes + kCheckpointBytes of the file are read.
+bool ends_cleanly(FILE* file, long size, bool binary) {
+    const std::size_t window = std::min<std::size_t>(static_cast<std::size_t>(size), kBlockBytes + kCheckpointBytes);
+    const std::size_t tail_start = static_cast<std::size_t>(size) - window;
+    std::vector<std::uint8_t> tail(window);
+    if (std::fseek(file, static_cast<long>(tail_start), SEEK_SET) != 0 ||
+        std::fread(tail.data(), 1, window, file) != window) {
+        return false;
+    }
+
+    if (binary) {
+        // File offsets: records line up with the end of the 12-byte header.
+        BinCheckpoint record{};
+        if (window < sizeof(record) || static_cast<std::size_t>(size) % sizeof(Frame) != 0) {
+            return false;
+        }
+        std::memcpy(&record, tail.data() + window - sizeof(record), sizeof(record));
+        const std::size_t seg_end = static_cast<std::size_t>(size) - sizeof(record);
+        if (record.tag != static_cast<std::uint8_t>(Tag::CHECKPOINT) || record.length > seg_end - tail_start) {
+            return false;
+        }
+        const std::size_t seg_start = seg_end - record.length;
+        if (seg_start % sizeof(Frame) != 0 || crc32(tail.data() + seg_start - tail_start, record.length) != record.crc32) {
+            return false;
+        }
+        for (std::size_t offset = std::max(seg_start, sizeof(BinHeader)); offset < seg_end; offset += sizeof(Frame)) {
+            if (tail[offset - tail_start] == static_cast<std::uint8_t>(Tag::STOP)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    if (window < 2 || tail[window - 1] != '\n') {
+        return false;
+    }
+    // Offsets into tail from here on.
+    std::size_t line_start = window - 1;
+    while (line_start > 0 && tail[line_start - 1] != '\n') {
+        --line_start;
+    }
+    const std::string line(reinterpret_cast<const char*>(tail.data() + line_start), window - 1 - line_start);
+    unsigned segment = 0;
+    unsigned length = 0;
+    unsigned crc = 0;
+    if (std::sscanf(line.c_str(), "CHECKPOINT : %u %u %x", &segment, &length, &crc) != 3 || length > line_start) {
+        return false;
+    }
+    const std::size_t seg_end = line_start;
+    const std::size_t seg_start = seg_end - length;
+    if (crc32(tail.data() + seg_start, length) != crc) {
+        return false;
+    }
+    for (std::size_t pos = seg_start; pos < seg_end;) {
+        if (std::strncmp(reinterpret_cast<const char*>(tail.data() + pos), "REC_STOP", 8) == 0) {
+            return true;
+        }
+        const void* newline = std::memchr(tail.data() + pos, '\n', seg_end - pos);
+        if (!newline) {
+            break;
+        }
+        pos = static_cast<std::size_t>(static_cast<const std::uint8_t*>(newline) - tail.data()) + 1;
+    }
+    return false;
+}
+
+// Running state of the full checkpoint walk.
+struct SegmentCheck {
+    RecordScan* scan;
+    std::size_t seg_start = 0;
+    std::uint32_t crc = kCrcInit;
+    bool seg_stopped = false;
+
+    // A flush never writes more than one block, so a longer run without a checkpoint is
+    // damage (or a log from before checkpoints) and the walk can stop.
+    bool overlong(std::size_t offset) const { return offset - seg_start > kBlockBytes; }
+
+    // Checks a checkpoint found at offset; false when it does not match the segment.
+    bool close(std::uint32_t segment, std::uint32_t length, std::uint32_t crc32_value, std::size_t offset,
+               std::size_t end) {
+        if (segment != scan->segments || length != offset - seg_start || ~crc != crc32_value) {
+            return false;
+        }
+        ++scan->segments;
+        scan->valid_end = end;
+        scan->stopped = seg_stopped;
+        seg_start = end;
+        crc = kCrcInit;
+        seg_stopped = false;
+        return true;
+    }
+};
+
+// Walks every checkpoint of a text log from the start, kScanChunkBytes at a time.
+bool scan_text(FILE* file, RecordScan* scan) {
+    std::vector<std::uint8_t> chunk(kScanChunkBytes);
+    SegmentCheck check{scan};
+    std::string line;
+    std::size_t offset = 0;  // file offset of the start of line
+    std::size_t got = 0;
+    while ((got = std::fread(chunk.data(), 1, chunk.size(), file)) > 0) {
+        for (std::size_t idx = 0; idx < got; ++idx) {
+            line.push_back(static_cast<char>(chunk[idx]));
+            if (chunk[idx] != '\n') {
+                if (line.size() > kMaxTextLine) {
+                    return scan->segments > 0;  // not a recording line: damaged from here on
+                }
+                continue;
+            }
+            const std::size_t line_end = offset + line.size();
+            if (check.overlong(line_end)) {
+                return scan->segments > 0;
+            }
+            if (starts_with(line.c_str(), "CHECKPOINT")) {
+                unsigned segment = 0;
+                unsigned length = 0;
+                unsigned crc = 0;
+                if (std::sscanf(line.c_str(), "CHECKPOINT : %u %u %x", &segment, &length, &crc) != 3 ||
+                    !check.close(segment, length, crc, offset, line_end)) {
+                    return scan->segments > 0;
+                }
+            } else {
+                if (starts_with(line.c_str(), "REC_STOP")) {
+                    check.seg_stopped = true;
+                }
+                check.crc = crc32_update(check.crc, reinterpret_cast<const std::uint8_t*>(line.data()), line.size());
+            }
+            offset = line_end;
+            line.clear();
+        }
+    }
+    return scan->segments > 0;  // a torn final line is simply not covered
+}
+
+// Same walk for a binary log; the header belongs to segment 0.
+bool scan_bin(FILE* file, RecordScan* scan) {
+    std::vector<std::uint8_t> chunk(kScanChunkBytes);
+    if (std::fread(chunk.data(), 1, sizeof(BinHeader), file) != sizeof(BinHeader) || !valid_bin_header(chunk.data())) {
+        return false;
+    }
+    SegmentCheck check{scan};
+    check.crc = crc32_update(check.crc, chunk.data(), sizeof(BinHeader));
+    std::size_t offset = sizeof(BinHeader);
+    std::size_t got = 0;
+    while ((got = std::fread(chunk.data(), 1, chunk.size(), file)) >= sizeof(Frame)) {
+        for (std::size_t idx = 0; idx + sizeof(Frame) <= got; idx += sizeof(Frame), offset += sizeof(Frame)) {
+            if (check.overlong(offset + sizeof(Frame))) {
+                return scan->segments > 0;
+            }
+            const std::uint8_t* record_bytes = chunk.data() + idx;
+            const auto tag = static_cast<Tag>(record_bytes[0]);
+            if (tag == Tag::CHECKPOINT) {
+                BinCheckpoint record{};
+                std::memcpy(&record, record_bytes, sizeof(record));
+                if (!check.close(record.segment, record.length, record.crc32, offset, offset + sizeof(record))) {
+                    return scan->segments > 0;
+                }
+                continue;
+            }
+            if (tag == Tag::STOP) {
+                check.seg_stopped = true;
+            }
+            check.crc = crc32_update(check.crc, record_bytes, sizeof(Frame));
+        }
+    }
+    return scan->segments > 0;
+}
+
+// Copies the first size bytes of from into a new file at to, a chunk at a time.
+bool copy_prefix(const char* from, const char* to, std::size_t size) {
+    FILE* in = std::fopen(from, "rb");
+    if (!in) {
+        return false;
+    }
+    FILE* out = std::fopen(to, "wb");
+    if (!out) {
+        std::fclose(in);
+        return false;
+    }
+    std::vector<std::uint8_t> chunk(kScanChunkBytes);
+    std::size_t left = size;
+    while (left > 0) {
+        const std::size_t got = std::fread(chunk.data(), 1, std::min(left, chunk.size()), in);
+        if (got == 0 || std::fwrite(chunk.data(), 1, got, out) != got) {
+            break;
+        }
+        left -= got;
+    }
+    std::fclose(in);
+    std::fclose(out);
+    return left == 0;
+}
+
+// Cuts a recording back to its last good checkpoint and, if REC_STOP never made it to
+// the card, closes it with REC_STOP : RECOVERED. Logs that ended cleanly are recognised
+// from their last block; logs without any checkpoint (older firmware) are left untouched.
+// settled is set for both: nothing older than them needs a look either.
+bool recover_log(const char* path, bool* settled) {
+    *settled = false;
+    FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    std::uint8_t magic[sizeof(kBinMagic)] = {};
+    const bool binary = std::fread(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+                        std::memcmp(magic, kBinMagic, sizeof(kBinMagic)) == 0;
+    std::fseek(file, 0, SEEK_END);
+    const long size = std::ftell(file);
+    if (size <= 0) {
+        std::fclose(file);
+        return false;
+    }
+    if (ends_cleanly(file, size, binary)) {
+        std::fclose(file);
+        *settled = true;
+        return false;
+    }
+    std::fseek(file, 0, SEEK_SET);
+    RecordScan scan;
+    const bool found = binary ? scan_bin(file, &scan) : scan_text(file, &scan);
+    std::fclose(file);
+    *settled = !found;
+    if (!found || (scan.stopped && scan.valid_end == static_cast<std::size_t>(size))) {
+        return false;
+    }
+
+    // Torn bytes after the last checkpoint: keep only the good prefix.
+    if (scan.valid_end < static_cast<std::size_t>(size)) {
+        const bool trimmed = copy_prefix(path, kRecoverScratchPath, scan.valid_end) &&
+                             copy_prefix(kRecoverScratchPath, path, scan.valid_end);
+        std::remove(kRecoverScratchPath);  // not in the manifest; never leave it on the card
+        if (!trimmed) {
+            return false;
+        }
+    }
+
+    std::size_t total = scan.valid_end;
+    if (!scan.stopped) {
+        std::uint8_t closing[sizeof(BinStop) + 32 + kCheckpointBytes];
+        std::size_t used = 0;
+        if (binary) {
+            BinStop stop{};
+            stop.tag = static_cast<std::uint8_t>(Tag::STOP);
+            std::strncpy(stop.reason, kRecoveredReason, sizeof(stop.reason));
+            std::memcpy(closing, &stop, sizeof(stop));
+            used = sizeof(stop);
+        } else {
+            used = static_cast<std::size_t>(
+                std::max(0, std::snprintf(reinterpret_cast<char*>(closing), 32, "REC_STOP : %s\n", kRecoveredReason)));
+        }
+        used = append_checkpoint(closing, 0, used, binary ? Format::BINARY : Format::TEXT, scan.segments);
+        file = std::fopen(path, "ab");
+        if (!file) {
+            return false;
+        }
+        std::fwrite(closing, 1, used, file);
+        std::fclose(file);
+        total += used;
+    }
+    sd_manifest::note(path, static_cast<long>(total));
+    return true;
+}
+}  // namespace
+
+void parse_config_line(const char* line, Config* config) {
+    if (!line || !config) {
+        return;
+    }
+    const std::string entry = trim_upper(line);
+    if (entry.empty() || entry[0] == '#') {
+        return;
+    }
+    const std::size_t eq = entry.find('=');
+    if (eq == std::string::npos) {
+        return;
+    }
+    const std::string key = trim_upper(entry.substr(0, eq).c_str());
+    const std::string value = trim_upper(entry.substr(eq + 1).c_str());
+
+    if (key == "FORMAT") {
+        if (value == "BINARY") {
+            config->format = Format::BINARY;
+        } else if (value == "TEXT") {
+            config->format = Format::TEXT;
+        }
+    } else if (key == "DELTA") {
+        config->delta = (value == "ON" || value == "1" || value == "TRUE");
+    } else if (key == "DEADBAND") {
+        config->deadband = std::max(0, std::atoi(value.c_str()));
+    } else if (key == "TELEMETRY_MS") {
+        const int period = std::atoi(value.c_str());
+        config->telemetry_ms = period <= 0 ? 0 : std::max<std::uint32_t>(period, kTelemetryMinPeriodMs);
+    }
+}
+
+Config load_config(FILE* file) {
+    Config loaded;
+    if (!file) {
+        return loaded;
+    }
+    char line[96];
+    while (std::fgets(line, sizeof(line), file)) {
+        parse_config_line(line, &loaded);
+    }
+    return loaded;
+}
+
+void set_config(const Config& config) {
+    g_mutex.take();
+    if (!g_recording) {
+        g_config = config;
+    }
+    g_mutex.give();
+}
+
+const Config& config() {
+    return g_config;
+}
+
+std::string make_log_path() {
+    char path[128];
+    std::snprintf(path, sizeof(path), "%s%s%u.%s", kLogDir, kLogName, pros::millis(),
+                  g_config.format == Format::BINARY ? "bin" : "txt");
+    return std::string(path);
+}
+
+bool start(const char* path, const Session& session) {
+    g_mutex.take();
+    if (g_recording && g_file) {
+        g_mutex.give();
+        return true;
+    }
+
+    g_path = path ? path : "";
+    g_file = g_path.empty() ? nullptr : std::fopen(g_path.c_str(), "w");
+    if (!g_file) {
+        g_recording = false;
+        g_path.clear();
+        g_mutex.give();
+        return false;
+    }
+
+    g_session = session;
+    g_block_used = 0;
+    g_ring.tail.store(g_ring.head.load(std::memory_order_acquire), std::memory_order_release);
+    g_ring.overruns.store(0);
+    g_telemetry_ring.tail.store(g_telemetry_ring.head.load());
+    g_telemetry_ring.drops.store(0);
+    g_telemetry_last_ms = 0;
+    g_have_last = false;
+    g_repeat = 0;
+    g_repeat_us = 0;
+    g_loop_stats = LoopStats{};
+    g_last_us = 0;
+    g_segment = 0;
+    if (g_config.format == Format::BINARY) {
+        BinHeader header{};
+        std::memcpy(header.magic, kBinMagic, sizeof(header.magic));
+        header.version = kBinVersion;
+        header.record_size = sizeof(Frame);
+        header.drive_mode = session.drive_mode;
+        header.program = static_cast<std::uint8_t>(session.program);
+        append_locked(&header, sizeof(header));
+    } else {
+        append_line_locked("REC_START", session.program_name);
+        if (session.drive_mode_name) {
+            append_line_locked("DRIVE_MODE", session.drive_mode_name);
+        }
+    }
+    flush_locked();
+    // Indexed now rather than at stop() so recover_logs() still finds it after a brownout.
+    sd_manifest::note(g_path.c_str(), std::ftell(g_file));
+    g_recording = true;
+    g_mutex.give();
+    return true;
+}
+
+void stop(const char* reason) {
+    g_mutex.take();
+    g_recording = false;
+    if (!g_file) {
+        g_mutex.give();
+        return;
+    }
+
+    drain_locked();
+    flush_repeat_locked();
+    write_loop_stats_locked();
+    const std::uint32_t overruns = g_ring.overruns.load();
+    if (overruns > 0) {
+        if (g_config.format == Format::BINARY) {
+            append_count_locked(Tag::OVERRUN, overruns);
+        } else {
+            append_line_locked("REC_OVERRUN", static_cast<int>(overruns));
+        }
+    }
+    const std::uint32_t telemetry_drops = g_telemetry_ring.drops.load();
+    if (telemetry_drops > 0) {
+        if (g_config.format == Format::BINARY) {
+            append_count_locked(Tag::TELEMETRY_DROP, telemetry_drops);
+        } else {
+            append_line_locked("REC_TELEMETRY_DROP", static_cast<int>(telemetry_drops));
+        }
+    }
+    if (reason && reason[0] != '\0') {
+        append_stop_locked(reason);
+    }
+    flush_locked();
+    sd_manifest::close_and_note(g_file, g_path.c_str());
+    g_file = nullptr;
+    g_mutex.give();
+}
+
+bool is_recording() {
+    return g_recording;
+}
+
+void status(bool* active, std::string* path, std::uint32_t* overruns, std::uint32_t* telemetry_drops) {
+    g_mutex.take();
+    if (active) {
+        *active = g_recording;
+    }
+    if (path) {
+        *path = g_path;
+    }
+    if (overruns) {
+        *overruns = g_ring.overruns.load();
+    }
+    if (telemetry_drops) {
+        *telemetry_drops = g_telemetry_ring.drops.load();
+    }
+    g_mutex.give();
+}
+
+void push_frame(const int axes[4], std::uint16_t buttons) {
+    if (!g_recording) {
+        return;
+    }
+
+    Frame frame{};
+    frame.tag = static_cast<std::uint8_t>(Tag::FRAME);
+    // Period since the previous control tick; 0 marks the first frame of a recording.
+    const std::uint64_t now_us = pros::micros();
+    frame.dt_us = g_last_us == 0 ? 0 : static_cast<std::uint32_t>(now_us - g_last_us);
+    g_last_us = now_us;
+    for (int idx = 0; idx < 4; ++idx) {
+        frame.axis[idx] = static_cast<std::int8_t>(std::max(-127, std::min(127, axes[idx])));
+    }
+    frame.buttons = buttons;
+
+    const std::uint32_t head = g_ring.head.load(std::memory_order_relaxed);
+    const std::uint32_t tail = g_ring.tail.load(std::memory_order_acquire);
+    if (head - tail >= kRingFrames) {
+        g_ring.overruns.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    g_ring.frames[head % kRingFrames] = frame;
+    g_ring.head.store(head + 1, std::memory_order_release);
+}
+
+bool telemetry_due() {
+    if (!g_recording || g_config.telemetry_ms == 0) {
+        return false;
+    }
+    const std::uint32_t now = pros::millis();
+    if (g_telemetry_last_ms != 0 && now - g_telemetry_last_ms < g_config.telemetry_ms) {
+        return false;
+    }
+    g_telemetry_last_ms = now;
+    return true;
+}
+
+void push_telemetry(double heading_deg, const MotorSample* motors, std::size_t count) {
+    if (!g_recording) {
+        return;
+    }
+    TelemetryRing& ring = g_telemetry_ring;
+    const std::uint32_t head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) >= kTelemetryRingSamples) {
+        ring.drops.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    TelemetrySample& sample = ring.samples[head % kTelemetryRingSamples];
+    sample.after_frame = g_ring.head.load(std::memory_order_relaxed);
+    sample.time_ms = pros::millis();
+    sample.heading_centideg = (std::isfinite(heading_deg) && heading_deg >= 0.0 && heading_deg < 360.0)
+                                  ? static_cast<std::uint16_t>(heading_deg * 100.0)
+                                  : 0;
+    sample.motor_count = static_cast<std::uint8_t>(std::min(count, kMaxTelemetryMotors));
+    std::copy(motors, motors + sample.motor_count, sample.motors);
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+MotorSample sample_motor(const pros::AbstractMotor& motor, std::uint8_t index) {
+    MotorSample out{};
+    out.tag = static_cast<std::uint8_t>(Tag::MOTOR);
+    out.index = index;
+    const int count = std::max<int>(1, motor.size());
+    double velocity = 0.0;
+    std::int32_t current = 0;
+    double temperature = 0.0;
+    for (int idx = 0; idx < count; ++idx) {
+        const auto member = static_cast<std::uint8_t>(idx);
+        velocity += motor.get_actual_velocity(member);
+        current += std::max<std::int32_t>(0, motor.get_current_draw(member));
+        temperature = std::max(temperature, motor.get_temperature(member));
+        if (motor.is_over_temp(member) == 1) out.flags |= kMotorOverTemp;
+        if (motor.is_over_current(member) == 1) out.flags |= kMotorOverCurrent;
+    }
+    out.velocity_rpm = static_cast<std::int16_t>(std::lround(velocity / count));
+    out.position_deg = static_cast<std::int32_t>(std::lround(motor.get_position(0)));
+    out.current_ma = static_cast<std::uint16_t>(std::min<std::int32_t>(current, 0xFFFF));
+    out.temperature_c = static_cast<std::uint8_t>(std::max(0.0, std::min(255.0, temperature)));
+    return out;
+}
+
+void start_writer_task(std::uint32_t priority, const char* name) {
+    static pros::Task writer(writer_task_fn, nullptr, priority, TASK_STACK_DEPTH_DEFAULT, name);
+}
+
+// Boot-time pass over the recordings listed in the SD manifest, for ones left open by a
+// brownout or a killed program. Only one log is written at a time and every boot runs
+// this pass, so it walks back from the newest log and stops at the first one that ended
+// cleanly; older logs were checked on earlier boots.
+int recover_logs() {
+    if (!sd_manifest::ensure_loaded()) {
+        return 0;
+    }
+
+    int recovered = 0;
+    const std::vector<sd_manifest::Entry> logs = sd_manifest::find(kLogDir, kLogName, nullptr);
+    for (auto entry = logs.rbegin(); entry != logs.rend(); ++entry) {
+        bool settled = false;
+        if (recover_log(entry->path.c_str(), &settled)) {
+            ++recovered;
+        }
+        if (settled) {
+            break;
+        }
+    }
+    return recovered;
+}
+
+}  // namespace recorder
@@ -1,17 +1,63 @@
 #include "main.h"
+#include "sd_manifest.hpp"
+#include "image_codec.hpp"
 
 #include <algorithm>
 #include <cctype>
 #include <cstdio>
 #include <cstring>
 #include <cmath>
+#include <memory>
+#include <new>
 #include <string>
 #include <vector>
 
+using image_codec::BmpInfo;
+using image_codec::ScaleFilter;
+using image_codec::V5ImgInfo;
+using image_codec::V5ImgReader;
+using image_codec::convert_bmp_row;
+using image_codec::decode_bmp_frame;
+using image_codec::draw_bmp_fast;
+using image_codec::draw_bmp_streaming;
+using image_codec::draw_v5img;
+using image_codec::ends_with_v5img;
+using image_codec::kBmpChunkBytes;
+using image_codec::kScaleFilterNames;
+using image_codec::kV5ImgExt;
+using image_codec::kV5ImgHeaderBytes;
+using image_codec::kV5ImgMagic;
+using image_codec::kV5ImgRaw;
+using image_codec::kV5ImgVersion;
+using image_codec::parse_scale_filter;
+using image_codec::read_bmp_info;
+using image_codec::read_v5img_info;
+using image_codec::v5img_read;
+using image_codec::v5img_reader_start;
+using image_codec::v5img_sibling;
+
 namespace {
 constexpr char kUiConfigName[] = "ui_images.txt";
 constexpr char kDefaultSplash[] = "loading_icon.bmp";
 constexpr char kDefaultAuton[] = "jerkbot.bmp";
+constexpr char kBenchName[] = "bmp_bench.txt";
+constexpr int kScreenW = 480;
+constexpr int kScreenH = 240;
+constexpr int kBenchRuns = 3;
+constexpr std::size_t kPrefetchSlots = 4;  // shown image, both neighbours and the one just left
+constexpr int kPrefetchIdleMs = 20;
+constexpr char kThumbDir[] = "/usd/Images/.thumbs/";
+constexpr int kThumbW = 112;
+constexpr int kThumbH = 56;
+constexpr int kGridCols = 4;
+constexpr int kGridRows = 3;
+constexpr int kGridPerPage = kGridCols * kGridRows;
+constexpr int kGridTop = 40;
+constexpr int kGridCellW = 120;
+constexpr int kGridCellH = 66;
+
+// How images larger than the screen are shrunk (SCALE_FILTER= in ui_images.txt).
+ScaleFilter g_scale_filter = ScaleFilter::BOX;
 
 struct Rect {
     int x;
@@ -33,9 +79,7 @@ bool starts_with(const char* str, const char* prefix) {
 }
 
 bool try_mount_sd() {
-    char buffer[64] = {0};
-    errno = 0;
-    return pros::usd::list_files("/", buffer, sizeof(buffer)) != PROS_ERR;
+    return sd_manifest::card_present();
 }
 
 FILE* sd_open(const char* name, const char* mode) {
@@ -78,117 +122,50 @@ FILE* sd_open(const char* name, const char* mode) {
     return nullptr;
 }
 
-bool draw_bmp_from_sd(const char* name, int x, int y) {
+enum class BmpPath { AUTO, STREAMING, FAST, NATIVE };
+
+bool draw_v5img_from_sd(const char* name, int x, int y) {
     FILE* file = sd_open(name, "rb");
     if (!file) {
         return false;
     }
+    V5ImgInfo info;
+    const bool ok = read_v5img_info(file, &info) && draw_v5img(file, info, x, y);
+    std::fclose(file);
+    return ok;
+}
 
-    std::uint8_t header[54];
-    if (std::fread(header, 1, sizeof(header), file) != sizeof(header)) {
-        std::fclose(file);
-        return false;
-    }
-
-    const std::uint32_t data_offset = *reinterpret_cast<std::uint32_t*>(&header[10]);
-    const std::int32_t width = *reinterpret_cast<std::int32_t*>(&header[18]);
-    const std::int32_t height = *reinterpret_cast<std::int32_t*>(&header[22]);
-    const std::uint16_t bpp = *reinterpret_cast<std::uint16_t*>(&header[28]);
-    const std::uint32_t compression = *reinterpret_cast<std::uint32_t*>(&header[30]);
-
-    const bool compression_ok = (compression == 0) || (compression == 3 && bpp == 32);
-    if ((bpp != 24 && bpp != 32) || !compression_ok || width <= 0 || height == 0) {
-        std::fclose(file);
-        return false;
-    }
-
-    const bool top_down = height < 0;
-    const std::int32_t abs_height = std::abs(height);
-    const std::uint32_t bytes_per_pixel = bpp / 8;
-    const std::uint32_t row_size = ((bytes_per_pixel * width + 3) / 4) * 4;
-    const int max_w = 480;
-    const int max_h = 240;
-    int target_w = width;
-    int target_h = abs_height;
-    bool scale = false;
-    if (width > max_w || abs_height > max_h) {
-        target_w = std::min(static_cast<int>(width), max_w);
-        target_h = std::min(static_cast<int>(abs_height), max_h);
-        scale = true;
+// AUTO prefers a .v5img sibling listed in the SD manifest, then the chunked BMP draw,
+// then streaming. The other paths force one method (used by BENCH).
+bool draw_bmp_from_sd(const char* name, int x, int y, BmpPath path = BmpPath::AUTO) {
+    if (ends_with_v5img(name)) {
+        return draw_v5img_from_sd(name, x, y);
     }
-
-    std::vector<std::uint8_t> row(row_size);
-    std::vector<std::uint32_t> row_buf(static_cast<std::size_t>(target_w));
-
-    std::fseek(file, static_cast<long>(data_offset), SEEK_SET);
-
-    int last_target_row = -1;
-    for (std::int32_t row_idx = 0; row_idx < abs_height; ++row_idx) {
-        if (std::fread(row.data(), 1, row_size, file) != row_size) {
-            break;
+    if (path == BmpPath::AUTO || path == BmpPath::NATIVE) {
+        const std::string native = v5img_sibling(name);
+        if (sd_manifest::contains(native.c_str()) && draw_v5img_from_sd(native.c_str(), x, y)) {
+            return true;
         }
-
-        const std::int32_t draw_y = top_down ? row_idx : (abs_height - 1 - row_idx);
-
-        if (!scale) {
-            for (std::int32_t col = 0; col < width; ++col) {
-                const std::size_t idx = static_cast<std::size_t>(col * bytes_per_pixel);
-                const std::uint8_t b = row[idx];
-                const std::uint8_t g = row[idx + 1];
-                const std::uint8_t r = row[idx + 2];
-                row_buf[static_cast<std::size_t>(col)] = (static_cast<std::uint32_t>(r) << 16) |
-                                                         (static_cast<std::uint32_t>(g) << 8) |
-                                                         static_cast<std::uint32_t>(b);
-            }
-
-            const std::int16_t y_row = static_cast<std::int16_t>(y + draw_y);
-            pros::screen::copy_area(x,
-                                    y_row,
-                                    static_cast<std::int16_t>(x + width - 1),
-                                    y_row,
-                                    row_buf.data(),
-                                    width);
-            continue;
+        if (path == BmpPath::NATIVE) {
+            return false;
         }
+    }
 
-        const int target_row = (draw_y * target_h) / abs_height;
-        if (target_row == last_target_row) {
-            continue;
-        }
-        last_target_row = target_row;
-
-        for (int col = 0; col < target_w; ++col) {
-            const int src_x = (col * width) / target_w;
-            const std::size_t idx = static_cast<std::size_t>(src_x * bytes_per_pixel);
-            const std::uint8_t b = row[idx];
-            const std::uint8_t g = row[idx + 1];
-            const std::uint8_t r = row[idx + 2];
-            row_buf[static_cast<std::size_t>(col)] = (static_cast<std::uint32_t>(r) << 16) |
-                                                     (static_cast<std::uint32_t>(g) << 8) |
-                                                     static_cast<std::uint32_t>(b);
-        }
+    FILE* file = sd_open(name, "rb");
+    if (!file) {
+        return false;
+    }
 
-        const std::int16_t y_row = static_cast<std::int16_t>(y + target_row);
-        if (y_row < 0 || y_row >= max_h) {
-            continue;
+    BmpInfo info;
+    bool ok = read_bmp_info(file, &info);
+    if (ok) {
+        if (path == BmpPath::STREAMING || !draw_bmp_fast(file, info, x, y, g_scale_filter)) {
+            ok = path != BmpPath::FAST && draw_bmp_streaming(file, info, x, y, g_scale_filter);
         }
-        pros::screen::copy_area(x,
-                                y_row,
-                                static_cast<std::int16_t>(x + target_w - 1),
-                                y_row,
-                                row_buf.data(),
-                                target_w);
     }
 
     std::fclose(file);
-    return true;
-}
-
-bool ends_with_bmp(const std::string& name) {
-    if (name.size() < 4) return false;
-    const std::string suffix = name.substr(name.size() - 4);
-    return suffix == ".bmp" || suffix == ".BMP" || suffix == ".Bmp" || suffix == ".bMp" ||
-           suffix == ".bmP" || suffix == ".bMP" || suffix == ".BmP" || suffix == ".BMP";
+    return ok;
 }
 
 void chomp_line(char* line) {
@@ -221,6 +198,408 @@ std::string coerce_images_path(const std::string& path) {
     }
     return std::string("/usd/Images/") + name;
 }
+
+// Screen-ready copy of an image: 0x00RRGGBB pixels drawn offset_x/offset_y in from the
+// origin (non-zero for scaled BMPs, which are centred).
+struct DecodedImage {
+    std::string key;
+    int width = 0;
+    int height = 0;
+    int offset_x = 0;
+    int offset_y = 0;
+    std::unique_ptr<std::uint32_t[]> pixels;
+    std::uint32_t last_used = 0;
+};
+
+// Images around the one on screen, decoded by the prefetch task so PREV/NEXT is a
+// single blit. Holds at most kPrefetchSlots images and evicts the least recently shown
+// one that is no longer wanted.
+struct PrefetchCache {
+    std::vector<DecodedImage> images;
+    std::vector<std::string> wanted;  // shown image first, then its neighbours
+    std::vector<std::string> failed;  // could not be decoded; drawn by streaming instead
+    std::uint32_t clock = 0;
+    std::uint32_t hits = 0;
+    std::uint32_t misses = 0;
+    bool paused = false;
+    bool busy = false;
+};
+
+PrefetchCache g_prefetch;
+pros::Mutex g_prefetch_mutex;
+
+bool decode_bmp_image(FILE* file, const BmpInfo& info, DecodedImage* out) {
+    const std::size_t pixels = static_cast<std::size_t>(info.target_w) * info.target_h;
+    out->pixels.reset(new (std::nothrow) std::uint32_t[pixels]());
+    if (!out->pixels || !decode_bmp_frame(file, info, out->pixels.get(), g_scale_filter)) {
+        out->pixels.reset();
+        return false;
+    }
+    out->width = info.target_w;
+    out->height = info.target_h;
+    out->offset_x = info.offset_x;
+    out->offset_y = info.offset_y;
+    return true;
+}
+
+bool decode_v5img_image(FILE* file, const V5ImgInfo& info, DecodedImage* out) {
+    const std::size_t pixels = static_cast<std::size_t>(info.width) * info.height;
+    std::unique_ptr<V5ImgReader> reader(new (std::nothrow) V5ImgReader());
+    out->pixels.reset(new (std::nothrow) std::uint32_t[pixels]());
+    if (!out->pixels || !reader) {
+        out->pixels.reset();
+        return false;
+    }
+    out->width = info.width;
+    out->height = info.height;
+    v5img_reader_start(reader.get(), file, info);
+    v5img_read(reader.get(), out->pixels.get(), pixels);
+    return true;
+}
+
+// Same source choice as draw_bmp_from_sd (AUTO), decoded into memory instead of drawn.
+bool decode_image_file(const std::string& name, DecodedImage* out) {
+    const std::string native = ends_with_v5img(name) ? name : v5img_sibling(name);
+    if (native == name || sd_manifest::contains(native.c_str())) {
+        FILE* file = sd_open(native.c_str(), "rb");
+        V5ImgInfo info;
+        const bool ok = file && read_v5img_info(file, &info) && decode_v5img_image(file, info, out);
+        if (file) {
+            std::fclose(file);
+        }
+        if (ok || native == name) {
+            return ok;
+        }
+    }
+
+    FILE* file = sd_open(name.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    BmpInfo info;
+    const bool ok = read_bmp_info(file, &info) && decode_bmp_image(file, info, out);
+    std::fclose(file);
+    return ok;
+}
+
+DecodedImage* prefetch_find_locked(const std::string& name) {
+    for (DecodedImage& image : g_prefetch.images) {
+        if (image.key == name) {
+            return &image;
+        }
+    }
+    return nullptr;
+}
+
+bool prefetch_wanted_locked(const std::string& name) {
+    return std::find(g_prefetch.wanted.begin(), g_prefetch.wanted.end(), name) != g_prefetch.wanted.end();
+}
+
+void prefetch_store_locked(DecodedImage&& image) {
+    if (prefetch_find_locked(image.key)) {
+        return;
+    }
+    while (g_prefetch.images.size() >= kPrefetchSlots) {
+        // Oldest unwanted image first; if every slot is still wanted, the oldest one.
+        auto victim = g_prefetch.images.end();
+        for (auto it = g_prefetch.images.begin(); it != g_prefetch.images.end(); ++it) {
+            const bool better = victim == g_prefetch.images.end() ||
+                                (!prefetch_wanted_locked(it->key) && prefetch_wanted_locked(victim->key)) ||
+                                (prefetch_wanted_locked(it->key) == prefetch_wanted_locked(victim->key) &&
+                                 it->last_used < victim->last_used);
+            if (better) {
+                victim = it;
+            }
+        }
+        g_prefetch.images.erase(victim);
+    }
+    g_prefetch.images.push_back(std::move(image));
+}
+
+// Blits name if it is cached. Holding the mutex keeps the pixels alive while drawing.
+bool prefetch_draw(const std::string& name, int x, int y) {
+    g_prefetch_mutex.take();
+    DecodedImage* image = prefetch_find_locked(name);
+    if (image) {
+        image->last_used = ++g_prefetch.clock;
+        ++g_prefetch.hits;
+        pros::screen::copy_area(static_cast<std::int16_t>(x + image->offset_x),
+                                static_cast<std::int16_t>(y + image->offset_y),
+                                static_cast<std::int16_t>(x + image->offset_x + image->width - 1),
+                                static_cast<std::int16_t>(y + image->offset_y + image->height - 1),
+                                image->pixels.get(),
+                                image->width);
+    } else {
+        ++g_prefetch.misses;
+    }
+    g_prefetch_mutex.give();
+    return image != nullptr;
+}
+
+// Decodes name on the calling task (a cache miss on screen). False when it cannot be
+// decoded; the caller then streams it.
+bool prefetch_load_now(const std::string& name) {
+    DecodedImage image;
+    if (!decode_image_file(name, &image)) {
+        return false;
+    }
+    image.key = name;
+    g_prefetch_mutex.take();
+    image.last_used = ++g_prefetch.clock;
+    prefetch_store_locked(std::move(image));
+    g_prefetch_mutex.give();
+    return true;
+}
+
+void prefetch_want(std::vector<std::string> names) {
+    g_prefetch_mutex.take();
+    g_prefetch.wanted = std::move(names);
+    g_prefetch_mutex.give();
+}
+
+// Drops everything, e.g. after REFRESH/RESCAN when files may have been replaced.
+void prefetch_clear() {
+    g_prefetch_mutex.take();
+    g_prefetch.images.clear();
+    g_prefetch.wanted.clear();
+    g_prefetch.failed.clear();
+    g_prefetch_mutex.give();
+}
+
+// Stops the task from starting new decodes; pausing waits for the current one so
+// timings (BENCH) are not skewed by background SD reads.
+void prefetch_pause(bool paused) {
+    g_prefetch_mutex.take();
+    g_prefetch.paused = paused;
+    bool busy = g_prefetch.busy;
+    g_prefetch_mutex.give();
+    while (paused && busy) {
+        pros::delay(5);
+        g_prefetch_mutex.take();
+        busy = g_prefetch.busy;
+        g_prefetch_mutex.give();
+    }
+}
+
+void prefetch_task_fn(void*) {
+    while (true) {
+        std::string name;
+        g_prefetch_mutex.take();
+        if (!g_prefetch.paused) {
+            for (const std::string& want : g_prefetch.wanted) {
+                const bool failed = std::find(g_prefetch.failed.begin(), g_prefetch.failed.end(), want) !=
+                                    g_prefetch.failed.end();
+                if (!failed && !prefetch_find_locked(want)) {
+                    name = want;
+                    break;
+                }
+            }
+        }
+        g_prefetch.busy = !name.empty();
+        g_prefetch_mutex.give();
+
+        if (name.empty()) {
+            pros::delay(kPrefetchIdleMs);
+            continue;
+        }
+
+        // The SD read and decode run without the mutex so the UI can keep blitting.
+        DecodedImage image;
+        const bool ok = decode_image_file(name, &image);
+        image.key = name;
+        g_prefetch_mutex.take();
+        if (ok) {
+            prefetch_store_locked(std::move(image));
+        } else {
+            g_prefetch.failed.push_back(name);
+        }
+        g_prefetch.busy = false;
+        g_prefetch_mutex.give();
+        pros::delay(1);
+    }
+}
+
+// Grid-view thumbnails: a box average of the whole image, at most kThumbW x kThumbH
+// with the aspect ratio kept, built in one sequential pass over the file and saved as
+// a raw .v5img under kThumbDir so later visits read only that.
+struct ThumbBuilder {
+    int src_w = 0;
+    int src_h = 0;
+    int width = 0;
+    int height = 0;
+    std::vector<std::uint16_t> col_of;  // thumbnail column of each source column
+    std::vector<std::uint32_t> sums;    // r, g, b, count per thumbnail pixel
+};
+
+void thumb_begin(ThumbBuilder* thumb, int src_w, int src_h) {
+    const std::int64_t w = src_w;
+    const std::int64_t h = src_h;
+    if (w * kThumbH >= h * kThumbW) {
+        thumb->width = std::min(src_w, kThumbW);
+        thumb->height = static_cast<int>(std::max<std::int64_t>(1, (h * thumb->width + w / 2) / w));
+    } else {
+        thumb->height = std::min(src_h, kThumbH);
+        thumb->width = static_cast<int>(std::max<std::int64_t>(1, (w * thumb->height + h / 2) / h));
+    }
+    thumb->src_w = src_w;
+    thumb->src_h = src_h;
+    thumb->col_of.resize(static_cast<std::size_t>(src_w));
+    for (int x = 0; x < src_w; ++x) {
+        thumb->col_of[x] = static_cast<std::uint16_t>((static_cast<std::int64_t>(x) * thumb->width) / src_w);
+    }
+    thumb->sums.assign(static_cast<std::size_t>(thumb->width) * thumb->height * 4, 0);
+}
+
+std::uint32_t* thumb_row_sums(ThumbBuilder* thumb, int draw_y) {
+    const int ty = static_cast<int>((static_cast<std::int64_t>(draw_y) * thumb->height) / thumb->src_h);
+    return thumb->sums.data() + static_cast<std::size_t>(ty) * thumb->width * 4;
+}
+
+void thumb_add_xrgb_row(ThumbBuilder* thumb, int draw_y, const std::uint32_t* row) {
+    std::uint32_t* sums = thumb_row_sums(thumb, draw_y);
+    for (int x = 0; x < thumb->src_w; ++x) {
+        std::uint32_t* cell = sums + thumb->col_of[x] * 4;
+        cell[0] += (row[x] >> 16) & 0xFF;
+        cell[1] += (row[x] >> 8) & 0xFF;
+        cell[2] += row[x] & 0xFF;
+        ++cell[3];
+    }
+}
+
+bool thumb_finish(const ThumbBuilder& thumb, DecodedImage* out) {
+    const std::size_t pixels = static_cast<std::size_t>(thumb.width) * thumb.height;
+    out->pixels.reset(new (std::nothrow) std::uint32_t[pixels]());
+    if (!out->pixels) {
+        return false;
+    }
+    out->width = thumb.width;
+    out->height = thumb.height;
+    out->offset_x = 0;
+    out->offset_y = 0;
+    for (std::size_t idx = 0; idx < pixels; ++idx) {
+        const std::uint32_t* cell = thumb.sums.data() + idx * 4;
+        const std::uint32_t count = std::max<std::uint32_t>(1, cell[3]);
+        const std::uint32_t r = (cell[0] + count / 2) / count;
+        const std::uint32_t g = (cell[1] + count / 2) / count;
+        const std::uint32_t b = (cell[2] + count / 2) / count;
+        out->pixels[idx] = (r << 16) | (g << 8) | b;
+    }
+    return true;
+}
+
+// Builds the thumbnail from the full image: BMP rows in kBmpChunkBytes reads, or a
+// .v5img decoded one row at a time.
+bool build_thumb(const std::string& name, DecodedImage* out) {
+    FILE* file = sd_open(name.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    ThumbBuilder thumb;
+    bool ok = false;
+    if (ends_with_v5img(name)) {
+        V5ImgInfo info;
+        std::unique_ptr<V5ImgReader> reader(new (std::nothrow) V5ImgReader());
+        if (reader && read_v5img_info(file, &info)) {
+            thumb_begin(&thumb, info.width, info.height);
+            std::vector<std::uint32_t> row(static_cast<std::size_t>(info.width));
+            v5img_reader_start(reader.get(), file, info);
+            int y = 0;
+            for (; y < info.height; ++y) {
+                if (v5img_read(reader.get(), row.data(), row.size()) != row.size()) {
+                    break;
+                }
+                thumb_add_xrgb_row(&thumb, y, row.data());
+            }
+            ok = y == info.height;
+        }
+    } else {
+        BmpInfo info;
+        if (read_bmp_info(file, &info)) {
+            thumb_begin(&thumb, info.width, info.rows);
+            const std::size_t chunk_rows = std::max<std::size_t>(1, kBmpChunkBytes / info.row_size);
+            std::unique_ptr<std::uint8_t[]> chunk(new (std::nothrow) std::uint8_t[chunk_rows * info.row_size]);
+            std::vector<std::uint32_t> row(static_cast<std::size_t>(info.width));
+            std::fseek(file, static_cast<long>(info.data_offset), SEEK_SET);
+            std::int32_t first = 0;
+            while (chunk && first < info.rows) {
+                const std::size_t want = std::min<std::size_t>(chunk_rows, static_cast<std::size_t>(info.rows - first));
+                const std::size_t got = std::fread(chunk.get(), info.row_size, want, file);
+                for (std::size_t idx = 0; idx < got; ++idx) {
+                    const std::int32_t row_idx = first + static_cast<std::int32_t>(idx);
+                    convert_bmp_row(info, chunk.get() + idx * info.row_size, row.data());
+                    thumb_add_xrgb_row(&thumb, info.top_down ? row_idx : info.rows - 1 - row_idx, row.data());
+                }
+                first += static_cast<std::int32_t>(got);
+                if (got < want) {
+                    break;
+                }
+            }
+            ok = chunk && first == info.rows;
+        }
+    }
+    std::fclose(file);
+    return ok && thumb_finish(thumb, out);
+}
+
+// "/usd/Images/jerkbot.bmp" -> "/usd/Images/.thumbs/jerkbot.bmp.v5img" (the full name
+// keeps jerkbot.bmp and jerkbot.v5img apart).
+std::string thumb_path(const std::string& name) {
+    const std::size_t slash = name.find_last_of('/');
+    return std::string(kThumbDir) + (slash == std::string::npos ? name : name.substr(slash + 1)) + kV5ImgExt;
+}
+
+// Best effort: PROS cannot create directories, so this only works once kThumbDir exists
+// (tools/bmp_to_v5img.py makes it). Without it thumbnails are rebuilt on each visit.
+void save_thumb(const std::string& path, const DecodedImage& thumb) {
+    FILE* file = sd_open(path.c_str(), "wb");
+    if (!file) {
+        return;
+    }
+    std::uint8_t header[kV5ImgHeaderBytes] = {};
+    const std::uint16_t width = static_cast<std::uint16_t>(thumb.width);
+    const std::uint16_t height = static_cast<std::uint16_t>(thumb.height);
+    const std::uint32_t data_offset = kV5ImgHeaderBytes;
+    std::memcpy(&header[0], kV5ImgMagic, sizeof(kV5ImgMagic));
+    std::memcpy(&header[4], &kV5ImgVersion, sizeof(kV5ImgVersion));
+    std::memcpy(&header[6], &width, sizeof(width));
+    std::memcpy(&header[8], &height, sizeof(height));
+    std::memcpy(&header[10], &kV5ImgRaw, sizeof(kV5ImgRaw));
+    std::memcpy(&header[12], &data_offset, sizeof(data_offset));
+    const std::size_t pixels = static_cast<std::size_t>(thumb.width) * thumb.height;
+    const bool ok = std::fwrite(header, 1, sizeof(header), file) == sizeof(header) &&
+                    std::fwrite(thumb.pixels.get(), sizeof(std::uint32_t), pixels, file) == pixels;
+    if (ok) {
+        sd_manifest::close_and_note(file, path.c_str());
+    } else {
+        std::fclose(file);
+    }
+}
+
+// Reads the sidecar when the manifest shows it was written after the image, otherwise
+// builds and saves a new one.
+bool load_thumb(const std::string& name, DecodedImage* out) {
+    const std::string path = thumb_path(name);
+    sd_manifest::Entry thumb_entry;
+    sd_manifest::Entry source_entry;
+    if (sd_manifest::lookup(path.c_str(), &thumb_entry) && sd_manifest::lookup(name.c_str(), &source_entry) &&
+        thumb_entry.seq > source_entry.seq) {
+        FILE* file = sd_open(path.c_str(), "rb");
+        V5ImgInfo info;
+        const bool ok = file && read_v5img_info(file, &info) && info.width <= kThumbW && info.height <= kThumbH &&
+                        decode_v5img_image(file, info, out);
+        if (file) {
+            std::fclose(file);
+        }
+        if (ok) {
+            return true;
+        }
+    }
+    if (!build_thumb(name, out)) {
+        return false;
+    }
+    save_thumb(path, *out);
+    return true;
+}
 } // namespace
 
 static std::vector<std::string> g_images;
@@ -228,38 +607,53 @@ static int g_index = 0;
 static std::string g_splash_name = kDefaultSplash;
 static std::string g_auton_name = kDefaultAuton;
 static std::string g_driver_name;
+static std::string g_image_cache_kb;  // Tahera's IMAGE_CACHE_KB, kept across saves
+static std::string g_bench_summary;
 static bool g_dirty = true;
-
-void add_images_from_dir(const char* list_path, const char* store_prefix) {
-    std::vector<char> buffer(16384, '\0');
-    if (pros::usd::list_files(list_path, buffer.data(), static_cast<int>(buffer.size())) == PROS_ERR) {
-        return;
-    }
-    buffer.back() = '\0';
-
-    const char* start = buffer.data();
-    while (*start) {
-        const char* end = std::strchr(start, '\n');
-        const std::size_t len = end ? static_cast<std::size_t>(end - start) : std::strlen(start);
-        if (len > 0) {
-            std::string name(start, len);
-            if (ends_with_bmp(name)) {
-                std::string full = store_prefix;
-                if (!full.empty() && full.back() != '/') {
-                    full += '/';
-                }
-                full += name;
-                g_images.push_back(full);
+static bool g_grid_view = false;
+static int g_grid_page = 0;
+static int g_grid_thumbs_page = -1;  // page g_grid_thumbs was loaded for
+static std::vector<DecodedImage> g_grid_thumbs;
+
+// Shown image first, then the next and previous ones (the likely taps).
+void prefetch_neighbours() {
+    std::vector<std::string> names;
+    const int count = static_cast<int>(g_images.size());
+    if (count > 0) {
+        for (int step : {0, 1, -1}) {
+            const std::string& name = g_images[(g_index + step + count) % count];
+            if (std::find(names.begin(), names.end(), name) == names.end()) {
+                names.push_back(name);
             }
         }
-        if (!end) break;
-        start = end + 1;
     }
+    prefetch_want(std::move(names));
 }
 
-void refresh_image_list() {
+// The image list comes from the SD manifest rather than a directory listing. REFRESH
+// re-reads the manifest (picking up one regenerated by tools/sd_manifest.py); RESCAN
+// rebuilds it from the card after images were copied over without the tool.
+void refresh_image_list(bool rescan = false) {
     g_images.clear();
-    add_images_from_dir("/Images", "/usd/Images");
+    prefetch_clear();
+    g_grid_thumbs_page = -1;
+    const bool indexed = rescan ? sd_manifest::rebuild() >= 0
+                                : (sd_manifest::load() || sd_manifest::ensure_loaded());
+    if (indexed) {
+        for (const sd_manifest::Entry& entry : sd_manifest::find("/usd/Images/", nullptr, ".bmp")) {
+            g_images.push_back(entry.path);
+        }
+        // .v5img files normally sit next to their BMP and are picked up when it is drawn;
+        // only list the ones copied over on their own.
+        const std::size_t bmp_count = g_images.size();
+        for (const sd_manifest::Entry& entry : sd_manifest::find("/usd/Images/", nullptr, kV5ImgExt)) {
+            const auto first = g_images.begin();
+            const auto last = first + static_cast<std::ptrdiff_t>(bmp_count);
+            if (std::none_of(first, last, [&](const std::string& bmp) { return v5img_sibling(bmp) == entry.path; })) {
+                g_images.push_back(entry.path);
+            }
+        }
+    }
     if (g_index >= static_cast<int>(g_images.size())) {
         g_index = 0;
     }
@@ -269,6 +663,8 @@ void load_config() {
     g_splash_name = coerce_images_path(kDefaultSplash);
     g_auton_name = coerce_images_path(kDefaultAuton);
     g_driver_name.clear();
+    g_image_cache_kb.clear();
+    g_scale_filter = ScaleFilter::BOX;
 
     FILE* file = sd_open(kUiConfigName, "r");
     if (!file) {
@@ -289,6 +685,10 @@ void load_config() {
             g_driver_name = coerce_images_path(line + 7);
         } else if (std::strncmp(line, "RUN=", 4) == 0) {
             legacy_run = line + 4;
+        } else if (std::strncmp(line, "IMAGE_CACHE_KB=", 15) == 0) {
+            g_image_cache_kb = line + 15;
+        } else if (std::strncmp(line, "SCALE_FILTER=", 13) == 0) {
+            parse_scale_filter(line + 13, &g_scale_filter);
         }
     }
 
@@ -310,7 +710,58 @@ void save_config() {
         std::fprintf(file, "DRIVER=%s\n", g_driver_name.c_str());
     }
     std::fprintf(file, "RUN=%s\n", g_auton_name.c_str());
-    std::fclose(file);
+    if (!g_image_cache_kb.empty()) {
+        std::fprintf(file, "IMAGE_CACHE_KB=%s\n", g_image_cache_kb.c_str());
+    }
+    if (g_scale_filter != ScaleFilter::BOX) {
+        std::fprintf(file, "SCALE_FILTER=%s\n", kScaleFilterNames[static_cast<int>(g_scale_filter)]);
+    }
+    sd_manifest::close_and_note(file, kUiConfigName);
+}
+
+// Times the per-row streaming draw, the chunked single-blit draw and the .v5img sibling
+// on the two default images (open + header + draw, averaged over kBenchRuns; 0 when
+// there is no .v5img). Results are shown under the image info and written to
+// bmp_bench.txt.
+void run_bmp_benchmark() {
+    const char* names[] = {kDefaultAuton, kDefaultSplash};
+    const BmpPath paths[] = {BmpPath::STREAMING, BmpPath::FAST, BmpPath::NATIVE};
+    constexpr int kPathCount = sizeof(paths) / sizeof(paths[0]);
+
+    FILE* out = sd_open(kBenchName, "w");
+    g_bench_summary = "us stream/fast/v5img:";
+    for (const char* name : names) {
+        const std::string path = coerce_images_path(name);
+        std::uint32_t avg_us[kPathCount] = {};
+        bool ok[kPathCount] = {};
+        for (int p = 0; p < kPathCount; ++p) {
+            std::uint64_t total_us = 0;
+            ok[p] = true;
+            for (int run = 0; run < kBenchRuns; ++run) {
+                const std::uint64_t start_us = pros::micros();
+                ok[p] = draw_bmp_from_sd(path.c_str(), 0, 0, paths[p]) && ok[p];
+                total_us += pros::micros() - start_us;
+            }
+            avg_us[p] = ok[p] ? static_cast<std::uint32_t>(total_us / kBenchRuns) : 0;
+        }
+
+        char row[96];
+        if (ok[0]) {
+            std::snprintf(row, sizeof(row), " %s %u/%u/%u", name, static_cast<unsigned>(avg_us[0]),
+                          static_cast<unsigned>(avg_us[1]), static_cast<unsigned>(avg_us[2]));
+        } else {
+            std::snprintf(row, sizeof(row), " %s missing", name);
+        }
+        g_bench_summary += row;
+        if (out) {
+            std::fprintf(out, "FILE=%s OK=%d STREAM_US=%u FAST_US=%u V5IMG_US=%u RUNS=%d\n", name, ok[0] ? 1 : 0,
+                         static_cast<unsigned>(avg_us[0]), static_cast<unsigned>(avg_us[1]),
+                         static_cast<unsigned>(avg_us[2]), kBenchRuns);
+        }
+    }
+    if (out) {
+        sd_manifest::close_and_note(out, kBenchName);
+    }
 }
 
 void draw_button(const Rect& r, const char* label, std::uint32_t color) {
@@ -319,14 +770,8 @@ void draw_button(const Rect& r, const char* label, std::uint32_t color) {
     pros::screen::print(TEXT_MEDIUM, r.x + 6, r.y + 8, label);
 }
 
-void draw_ui() {
-    pros::screen::set_pen(0x00000000);
-    pros::screen::fill_rect(0, 0, 479, 239);
-
-    if (!g_images.empty()) {
-        draw_bmp_from_sd(g_images[g_index].c_str(), 0, 0);
-    }
-
+// Buttons and the text block; drawn over the image.
+void draw_controls(bool loading) {
     const Rect prev_btn{10, 10, 70, 30};
     const Rect next_btn{90, 10, 70, 30};
     const Rect splash_btn{170, 10, 90, 30};
@@ -334,6 +779,9 @@ void draw_ui() {
     const Rect driver_btn{370, 10, 90, 30};
     const Rect save_btn{10, 50, 140, 30};
     const Rect refresh_btn{170, 50, 140, 30};
+    const Rect rescan_btn{330, 50, 130, 30};
+    const Rect bench_btn{370, 200, 90, 30};
+    const Rect grid_btn{270, 200, 90, 30};
 
     draw_button(prev_btn, "PREV", 0x00FFFFFF);
     draw_button(next_btn, "NEXT", 0x00FFFFFF);
@@ -342,6 +790,9 @@ void draw_ui() {
     draw_button(driver_btn, "DRIVER", 0x0000FFFF);
     draw_button(save_btn, "SAVE", 0x00FFFF00);
     draw_button(refresh_btn, "REFRESH", 0x00FFFFFF);
+    draw_button(rescan_btn, "RESCAN", 0x00FFFFFF);
+    draw_button(bench_btn, "BENCH", 0x00FFFFFF);
+    draw_button(grid_btn, "GRID", 0x00FFFFFF);
 
     pros::screen::set_pen(pros::c::COLOR_WHITE);
     if (g_images.empty()) {
@@ -352,12 +803,128 @@ void draw_ui() {
         if (pos != std::string::npos) {
             name = name.substr(pos + 1);
         }
-        pros::screen::print(TEXT_MEDIUM, 10, 100, "FILE: %s", name.c_str());
+        pros::screen::print(TEXT_MEDIUM, 10, 100, loading ? "FILE: %s (loading...)" : "FILE: %s", name.c_str());
     }
     pros::screen::print(TEXT_MEDIUM, 10, 130, "SPLASH: %s", g_splash_name.c_str());
     pros::screen::print(TEXT_MEDIUM, 10, 155, "AUTON: %s", g_auton_name.c_str());
     pros::screen::print(TEXT_MEDIUM, 10, 180, "DRIVER: %s",
                         g_driver_name.empty() ? "(none)" : g_driver_name.c_str());
+    if (!g_bench_summary.empty()) {
+        pros::screen::print(TEXT_SMALL, 10, 205, "%s", g_bench_summary.c_str());
+    }
+}
+
+Rect grid_cell(int cell) {
+    return Rect{(cell % kGridCols) * kGridCellW, kGridTop + (cell / kGridCols) * kGridCellH, kGridCellW, kGridCellH};
+}
+
+int grid_page_count() {
+    return std::max(1, (static_cast<int>(g_images.size()) + kGridPerPage - 1) / kGridPerPage);
+}
+
+// kGridPerPage thumbnails per page. Each one is drawn as soon as it is loaded, so a
+// first visit (which builds the sidecars) fills in visibly; after that a page is
+// twelve small reads. The shown image is outlined.
+void draw_grid() {
+    pros::screen::set_pen(0x00000000);
+    pros::screen::fill_rect(0, 0, 479, 239);
+
+    const Rect prev_page_btn{10, 5, 90, 28};
+    const Rect next_page_btn{110, 5, 90, 28};
+    const Rect back_btn{370, 5, 90, 28};
+    draw_button(prev_page_btn, "< PAGE", 0x00FFFFFF);
+    draw_button(next_page_btn, "PAGE >", 0x00FFFFFF);
+    draw_button(back_btn, "BACK", 0x00FFFFFF);
+    pros::screen::set_pen(pros::c::COLOR_WHITE);
+    pros::screen::print(TEXT_MEDIUM, 215, 12, "Page %d/%d", g_grid_page + 1, grid_page_count());
+
+    const bool reload = g_grid_thumbs_page != g_grid_page;
+    if (reload) {
+        g_grid_thumbs.clear();
+        g_grid_thumbs.resize(kGridPerPage);
+        g_grid_thumbs_page = g_grid_page;
+    }
+    for (int cell = 0; cell < kGridPerPage; ++cell) {
+        const int index = g_grid_page * kGridPerPage + cell;
+        if (index >= static_cast<int>(g_images.size())) {
+            break;
+        }
+        const Rect r = grid_cell(cell);
+        DecodedImage& thumb = g_grid_thumbs[cell];
+        if (reload && !load_thumb(g_images[index], &thumb)) {
+            thumb.pixels.reset();
+        }
+        if (thumb.pixels) {
+            const int x = r.x + (r.w - thumb.width) / 2;
+            const int y = r.y + (r.h - thumb.height) / 2;
+            pros::screen::copy_area(static_cast<std::int16_t>(x), static_cast<std::int16_t>(y),
+                                    static_cast<std::int16_t>(x + thumb.width - 1),
+                                    static_cast<std::int16_t>(y + thumb.height - 1), thumb.pixels.get(),
+                                    thumb.width);
+        } else {
+            pros::screen::set_pen(pros::c::COLOR_WHITE);
+            pros::screen::print(TEXT_SMALL, r.x + 8, r.y + r.h / 2, "?");
+        }
+        if (index == g_index) {
+            pros::screen::set_pen(0x00FFFF00);
+            pros::screen::draw_rect(r.x + 1, r.y + 1, r.x + r.w - 2, r.y + r.h - 2);
+        }
+    }
+}
+
+bool handle_grid_touch(int x, int y) {
+    const Rect prev_page_btn{10, 5, 90, 28};
+    const Rect next_page_btn{110, 5, 90, 28};
+    const Rect back_btn{370, 5, 90, 28};
+    const int pages = grid_page_count();
+
+    if (hit_test(prev_page_btn, x, y)) {
+        g_grid_page = (g_grid_page - 1 + pages) % pages;
+        return true;
+    }
+    if (hit_test(next_page_btn, x, y)) {
+        g_grid_page = (g_grid_page + 1) % pages;
+        return true;
+    }
+    if (hit_test(back_btn, x, y)) {
+        g_grid_view = false;
+        return true;
+    }
+    if (y < kGridTop) {
+        return false;
+    }
+    const int col = std::min(x / kGridCellW, kGridCols - 1);
+    const int row = std::min((y - kGridTop) / kGridCellH, kGridRows - 1);
+    const int index = g_grid_page * kGridPerPage + row * kGridCols + col;
+    if (index >= static_cast<int>(g_images.size())) {
+        return false;
+    }
+    g_index = index;
+    g_grid_view = false;
+    return true;
+}
+
+// A prefetched image is one blit. On a miss the controls go up first with a loading
+// note, then the image is decoded here (streamed if memory is short) and the controls
+// redrawn over it.
+void draw_ui() {
+    if (g_grid_view) {
+        draw_grid();
+        return;
+    }
+    pros::screen::set_pen(0x00000000);
+    pros::screen::fill_rect(0, 0, 479, 239);
+
+    const bool shown = g_images.empty() || prefetch_draw(g_images[g_index], 0, 0);
+    draw_controls(!shown);
+    if (!shown) {
+        const std::string& name = g_images[g_index];
+        if (!prefetch_load_now(name) || !prefetch_draw(name, 0, 0)) {
+            draw_bmp_from_sd(name.c_str(), 0, 0);
+        }
+        draw_controls(false);
+    }
+    prefetch_neighbours();
 }
 
 bool handle_touch() {
@@ -373,6 +940,9 @@ bool handle_touch() {
 
     const int x = status.x;
     const int y = status.y;
+    if (g_grid_view) {
+        return handle_grid_touch(x, y);
+    }
 
     const Rect prev_btn{10, 10, 70, 30};
     const Rect next_btn{90, 10, 70, 30};
@@ -381,6 +951,9 @@ bool handle_touch() {
     const Rect driver_btn{370, 10, 90, 30};
     const Rect save_btn{10, 50, 140, 30};
     const Rect refresh_btn{170, 50, 140, 30};
+    const Rect rescan_btn{330, 50, 130, 30};
+    const Rect bench_btn{370, 200, 90, 30};
+    const Rect grid_btn{270, 200, 90, 30};
 
     bool changed = false;
     if (hit_test(prev_btn, x, y) && !g_images.empty()) {
@@ -404,6 +977,18 @@ bool handle_touch() {
     } else if (hit_test(refresh_btn, x, y)) {
         refresh_image_list();
         changed = true;
+    } else if (hit_test(rescan_btn, x, y)) {
+        refresh_image_list(true);
+        changed = true;
+    } else if (hit_test(bench_btn, x, y)) {
+        prefetch_pause(true);
+        run_bmp_benchmark();
+        prefetch_pause(false);
+        changed = true;
+    } else if (hit_test(grid_btn, x, y)) {
+        g_grid_view = true;
+        g_grid_page = g_images.empty() ? 0 : g_index / kGridPerPage;
+        changed = true;
     }
 
     return changed;
@@ -413,6 +998,8 @@ void initialize() {
     pros::lcd::initialize();
     refresh_image_list();
     load_config();
+    static pros::Task prefetch_task(prefetch_task_fn, nullptr, TASK_PRIORITY_DEFAULT - 1,
+                                    TASK_STACK_DEPTH_DEFAULT, "ImgPrefetch");
     draw_ui();
     g_dirty = false;
 }
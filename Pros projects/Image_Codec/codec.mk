@@ -0,0 +1,13 @@
+# Shared image decoding (Image_Codec). Included from the Makefile of every project that
+# draws BMP or .v5img files: adds the header path and links the codec objects into the
+# hot image alongside the project's own src/ objects.
+CODEC_DIR:=$(ROOT)/../Image_Codec
+CODEC_SRC:=$(wildcard $(CODEC_DIR)/src/*.cpp)
+CODEC_OBJ:=$(patsubst $(CODEC_DIR)/src/%,$(BINDIR)/codec/%.o,$(CODEC_SRC))
+
+EXTRA_INCDIR+=$(CODEC_DIR)/include
+ELF_DEPS+=$(CODEC_OBJ)
+
+$(BINDIR)/codec/%.cpp.o: $(CODEC_DIR)/src/%.cpp $(wildcard $(CODEC_DIR)/include/*.hpp)
+	$(VV)mkdir -p $(dir $@)
+	$(call test_output_2,Compiled $< ,$(CXX) -c $(INCLUDE) $(CXXFLAGS) $(EXTRA_CXXFLAGS) -o $@ $<,$(OK_STRING))
@@ -0,0 +1,121 @@
+#pragma once
+
+// Image decoding shared by Tahera_Project, Image Selector and Auton_Planner_PROS.
+//
+// Reads uncompressed BMPs and .v5img files and turns them into the 0x00RRGGBB words
+// pros::screen::copy_area takes. Every BMP bit depth the V5 tooling writes is handled:
+// 24/32-bit BGR(X), 1/4/8-bit palettes, 16-bit RGB555 and 16/32-bit BI_BITFIELDS masks
+// in any channel order. The palette and the channel tables are built once per image by
+// read_bmp_info, so converting a row is one table read per pixel. BMPs larger than the
+// screen are scaled down while they are read, with the filter each caller picks.
+//
+// The projects keep only their own drawing, caching and SD lookups.
+//
+// Built into each project by Image_Codec/codec.mk.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace image_codec {
+
+// Images larger than this are scaled down to fit, aspect ratio kept.
+constexpr int kScreenW = 480;
+constexpr int kScreenH = 240;
+// Unscaled BMPs are read in pieces of this size.
+constexpr std::size_t kBmpChunkBytes = 64 * 1024;
+
+// How images larger than the screen are shrunk.
+enum class ScaleFilter { NEAREST, BOX, BILINEAR };
+constexpr const char* kScaleFilterNames[] = {"NEAREST", "BOX", "BILINEAR"};
+
+// "box", "BILINEAR", ... (case-insensitive). Leaves out alone for unknown names.
+bool parse_scale_filter(const char* text, ScaleFilter* out);
+
+// Pixel layout of an uncompressed BMP and where it lands on screen. Images larger than
+// 480x240 get a target size that fits and offsets that keep them centred.
+struct BmpInfo {
+    std::uint32_t data_offset = 0;
+    std::int32_t width = 0;
+    std::int32_t rows = 0;
+    bool top_down = false;
+    std::uint32_t bits_per_pixel = 0;
+    std::uint32_t row_size = 0;
+    std::vector<std::uint32_t> lut;  // palette, or the bitfield red, green and blue tables
+    std::uint32_t channel_shift[3] = {};
+    std::uint32_t channel_mask[3] = {};
+    std::uint32_t channel_base[3] = {};  // where each channel's table starts in lut
+    int target_w = 0;
+    int target_h = 0;
+    int offset_x = 0;
+    int offset_y = 0;
+    bool scaled = false;
+};
+
+// Reads the headers (and palette or bitfield masks) from the start of file. False for
+// anything that is not an uncompressed BMP in one of the depths above.
+bool read_bmp_info(FILE* file, BmpInfo* info);
+// One stored row (width source pixels) -> 0x00RRGGBB.
+void convert_bmp_row(const BmpInfo& info, const std::uint8_t* row, std::uint32_t* out);
+
+// One fread and one copy_area per row; needs only row-sized buffers.
+bool draw_bmp_streaming(FILE* file, const BmpInfo& info, int x, int y, ScaleFilter filter);
+// Fills frame (target_w * target_h) in one pass: unscaled images read the pixel array
+// in kBmpChunkBytes pieces, oversized ones go through the scaler. Returns false when a
+// buffer cannot be allocated.
+bool decode_bmp_frame(FILE* file, const BmpInfo& info, std::uint32_t* frame, ScaleFilter filter);
+// Decodes into one frame and pushes it with a single copy_area. Returns false (without
+// drawing) when the buffers cannot be allocated.
+bool draw_bmp_fast(FILE* file, const BmpInfo& info, int x, int y, ScaleFilter filter);
+
+// .v5img: a 16-byte header ("V5IM", version, width, height, encoding, data offset),
+// then width * height 0x00RRGGBB pixels, top-down, at most 480x240. Encoding 0 stores
+// them as raw little-endian words; encoding 1 is a QOI stream (index/diff/luma/run ops,
+// no alpha), usually several times smaller than the BMP. Written next to each BMP by
+// tools/bmp_to_v5img.py.
+constexpr char kV5ImgExt[] = ".v5img";
+constexpr char kV5ImgMagic[4] = {'V', '5', 'I', 'M'};
+constexpr std::uint16_t kV5ImgVersion = 1;
+constexpr std::size_t kV5ImgHeaderBytes = 16;
+constexpr std::uint16_t kV5ImgRaw = 0;
+constexpr std::uint16_t kV5ImgQoi = 1;
+constexpr std::size_t kV5ImgReadBytes = 2048;
+
+struct V5ImgInfo {
+    std::uint32_t data_offset = 0;
+    int width = 0;
+    int height = 0;
+    std::uint16_t encoding = kV5ImgRaw;
+};
+
+bool read_v5img_info(FILE* file, V5ImgInfo* info);
+
+// Produces the pixels of a .v5img body in order, in a single pass over the file. Raw
+// bodies are read straight into the caller's buffer; QOI bodies go through a small
+// read-ahead buffer and decode as they stream. Large; allocate it rather than putting
+// it on a task stack.
+struct V5ImgReader {
+    FILE* file = nullptr;
+    std::uint16_t encoding = kV5ImgRaw;
+    std::uint8_t buf[kV5ImgReadBytes];
+    std::size_t pos = 0;
+    std::size_t len = 0;
+    std::uint32_t index[64] = {};
+    std::uint32_t px = 0;
+    int run = 0;
+};
+
+void v5img_reader_start(V5ImgReader* reader, FILE* file, const V5ImgInfo& info);
+// Returns the number of pixels written to out (short only at end of file).
+std::size_t v5img_read(V5ImgReader* reader, std::uint32_t* out, std::size_t count);
+// Raw images go up in one read and one copy_area. QOI images decode a band of rows at a
+// time so no full-frame buffer is needed; without memory for a band it is one row.
+bool draw_v5img(FILE* file, const V5ImgInfo& info, int x, int y);
+
+// "<dir>/<stem>.bmp" -> "<dir>/<stem>.v5img".
+std::string v5img_sibling(const std::string& name);
+bool ends_with_v5img(const std::string& name);
+
+}  // namespace image_codec
@@ -0,0 +1,593 @@
+#include "image_codec.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+
+#include "api.h"
+
+namespace image_codec {
+namespace {
+// QOI bands drawn at a time by draw_v5img.
+constexpr int kV5ImgBandRows = 40;
+
+std::uint16_t read_le16(const std::uint8_t* p) {
+    return static_cast<std::uint16_t>(p[0] | (p[1] << 8));
+}
+
+std::uint32_t read_le32(const std::uint8_t* p) {
+    return static_cast<std::uint32_t>(p[0]) | (static_cast<std::uint32_t>(p[1]) << 8) |
+           (static_cast<std::uint32_t>(p[2]) << 16) | (static_cast<std::uint32_t>(p[3]) << 24);
+}
+
+// Adds the table for one 16-bit channel mask: every value the field can hold, expanded to
+// 8 bits and moved to its place in 0x00RRGGBB. Masks must be contiguous and at most 8 bits.
+bool add_channel_table(BmpInfo* info, int channel, std::uint32_t mask) {
+    std::uint32_t shift = 0;
+    while (mask && !(mask & (1u << shift))) {
+        ++shift;
+    }
+    const std::uint32_t field = mask >> shift;
+    if ((field & (field + 1)) != 0 || field > 0xFF) {
+        return false;
+    }
+    info->channel_shift[channel] = shift;
+    info->channel_mask[channel] = field;
+    info->channel_base[channel] = static_cast<std::uint32_t>(info->lut.size());
+    const int place = 16 - 8 * channel;
+    for (std::uint32_t value = 0; value <= field; ++value) {
+        const std::uint32_t expanded = field ? (value * 255 + field / 2) / field : 0;
+        info->lut.push_back(expanded << place);
+    }
+    return true;
+}
+
+// Lookup tables for drawing one oversized BMP, built once per image so the per-pixel
+// work is table reads, adds and shifts. Each target row seeks straight to the source
+// rows it needs: one for NEAREST, two for BILINEAR, the covered block for BOX.
+struct BmpScaler {
+    ScaleFilter filter = ScaleFilter::BOX;
+    std::vector<std::uint32_t> col_start;  // first source pixel of each column
+    std::vector<std::uint32_t> col_arg;    // BOX: pixels covered; BILINEAR: Q8 weight of the next pixel
+    std::vector<std::uint32_t> col_inv;    // BOX: Q16 reciprocal of col_arg
+    std::vector<std::uint8_t> rows;        // source rows read for the current target row
+    std::vector<std::uint32_t> pixels;     // the same rows as 0x00RRGGBB
+    std::vector<std::uint32_t> acc;        // BOX: per-column channel sums (Q8)
+};
+
+// Q8 source position of the centre of target pixel t, clamped to [0, (src - 1) << 8].
+std::int32_t scaler_center_q8(int t, int target, int src) {
+    const std::int64_t pos = ((2 * static_cast<std::int64_t>(t) + 1) * src * 128) / target - 128;
+    return static_cast<std::int32_t>(std::max<std::int64_t>(0, std::min<std::int64_t>(pos, (src - 1) * 256)));
+}
+
+void init_bmp_scaler(const BmpInfo& info, ScaleFilter filter, BmpScaler* scaler) {
+    scaler->filter = filter;
+    const std::size_t cols = static_cast<std::size_t>(info.target_w);
+    scaler->col_start.resize(cols);
+    scaler->col_arg.assign(cols, 0);
+    scaler->col_inv.assign(cols, 0);
+    std::size_t max_rows = 1;
+    for (std::size_t c = 0; c < cols; ++c) {
+        const int col = static_cast<int>(c);
+        int x0 = 0;
+        if (filter == ScaleFilter::BOX) {
+            x0 = static_cast<int>((static_cast<std::int64_t>(col) * info.width) / info.target_w);
+            const int x1 = static_cast<int>((static_cast<std::int64_t>(col + 1) * info.width) / info.target_w);
+            scaler->col_arg[c] = static_cast<std::uint32_t>(std::max(1, x1 - x0));
+            scaler->col_inv[c] = 65536u / scaler->col_arg[c];
+        } else if (filter == ScaleFilter::BILINEAR) {
+            const std::int32_t pos = scaler_center_q8(col, info.target_w, info.width);
+            x0 = pos >> 8;
+            scaler->col_arg[c] = x0 + 1 < info.width ? static_cast<std::uint32_t>(pos & 0xFF) : 0;
+        } else {
+            x0 = scaler_center_q8(col, info.target_w, info.width) >> 8;
+        }
+        scaler->col_start[c] = static_cast<std::uint32_t>(x0);
+    }
+    if (filter == ScaleFilter::BOX) {
+        max_rows = static_cast<std::size_t>((info.rows + info.target_h - 1) / info.target_h) + 1;
+        scaler->acc.assign(cols * 3, 0);
+    } else if (filter == ScaleFilter::BILINEAR) {
+        max_rows = 2;
+    }
+    scaler->rows.resize(max_rows * info.row_size);
+    scaler->pixels.resize(max_rows * static_cast<std::size_t>(info.width));
+}
+
+// Reads the source rows behind target row ty and writes its target_w pixels to out.
+bool scale_bmp_row(FILE* file, const BmpInfo& info, BmpScaler* scaler, int ty, std::uint32_t* out) {
+    int first = 0;
+    int count = 1;
+    std::uint32_t fy = 0;
+    if (scaler->filter == ScaleFilter::BOX) {
+        first = static_cast<int>((static_cast<std::int64_t>(ty) * info.rows) / info.target_h);
+        const int last = static_cast<int>((static_cast<std::int64_t>(ty + 1) * info.rows) / info.target_h);
+        count = std::max(1, last - first);
+    } else if (scaler->filter == ScaleFilter::BILINEAR) {
+        const std::int32_t pos = scaler_center_q8(ty, info.target_h, info.rows);
+        first = pos >> 8;
+        fy = static_cast<std::uint32_t>(pos & 0xFF);
+        count = (fy != 0 && first + 1 < info.rows) ? 2 : 1;
+    } else {
+        first = scaler_center_q8(ty, info.target_h, info.rows) >> 8;
+    }
+
+    // Rows [first, first + count) in draw order are contiguous in the file either way.
+    const std::int32_t file_row = info.top_down ? first : info.rows - first - count;
+    std::fseek(file, static_cast<long>(info.data_offset + static_cast<std::uint32_t>(file_row) * info.row_size),
+               SEEK_SET);
+    if (std::fread(scaler->rows.data(), info.row_size, static_cast<std::size_t>(count), file) !=
+        static_cast<std::size_t>(count)) {
+        return false;
+    }
+    // Converted in draw order, so pixel row k is source row first + k.
+    for (int k = 0; k < count; ++k) {
+        const int stored = info.top_down ? k : count - 1 - k;
+        convert_bmp_row(info, scaler->rows.data() + static_cast<std::size_t>(stored) * info.row_size,
+                        scaler->pixels.data() + static_cast<std::size_t>(k) * info.width);
+    }
+    auto draw_row = [&](int k) { return scaler->pixels.data() + static_cast<std::size_t>(k) * info.width; };
+
+    if (scaler->filter == ScaleFilter::BOX) {
+        std::fill(scaler->acc.begin(), scaler->acc.end(), 0u);
+        for (int k = 0; k < count; ++k) {
+            const std::uint32_t* row = draw_row(k);
+            std::uint32_t* acc = scaler->acc.data();
+            for (int col = 0; col < info.target_w; ++col, acc += 3) {
+                const std::uint32_t* px = row + scaler->col_start[col];
+                std::uint32_t b = 0, g = 0, r = 0;
+                for (std::uint32_t n = 0; n < scaler->col_arg[col]; ++n) {
+                    b += px[n] & 0xFF;
+                    g += (px[n] >> 8) & 0xFF;
+                    r += (px[n] >> 16) & 0xFF;
+                }
+                const std::uint32_t inv = scaler->col_inv[col];
+                acc[0] += (b * inv) >> 8;
+                acc[1] += (g * inv) >> 8;
+                acc[2] += (r * inv) >> 8;
+            }
+        }
+        const std::uint64_t inv_h = 65536u / static_cast<std::uint32_t>(count);
+        const std::uint32_t* acc = scaler->acc.data();
+        for (int col = 0; col < info.target_w; ++col, acc += 3) {
+            const std::uint32_t b = static_cast<std::uint32_t>((acc[0] * inv_h) >> 24);
+            const std::uint32_t g = static_cast<std::uint32_t>((acc[1] * inv_h) >> 24);
+            const std::uint32_t r = static_cast<std::uint32_t>((acc[2] * inv_h) >> 24);
+            out[col] = (std::min(r, 255u) << 16) | (std::min(g, 255u) << 8) | std::min(b, 255u);
+        }
+        return true;
+    }
+
+    if (scaler->filter == ScaleFilter::BILINEAR) {
+        const std::uint32_t* top = draw_row(0);
+        const std::uint32_t* bottom = count > 1 ? draw_row(1) : top;
+        for (int col = 0; col < info.target_w; ++col) {
+            const std::uint32_t fx = scaler->col_arg[col];
+            const std::uint32_t x0 = scaler->col_start[col];
+            const std::uint32_t x1 = fx ? x0 + 1 : x0;
+            std::uint32_t px = 0;
+            for (int place = 16; place >= 0; place -= 8) {
+                const std::uint32_t upper = ((top[x0] >> place) & 0xFF) * (256 - fx) + ((top[x1] >> place) & 0xFF) * fx;
+                const std::uint32_t lower =
+                    ((bottom[x0] >> place) & 0xFF) * (256 - fx) + ((bottom[x1] >> place) & 0xFF) * fx;
+                px = (px << 8) | ((upper * (256 - fy) + lower * fy + 32768) >> 16);
+            }
+            out[col] = px;
+        }
+        return true;
+    }
+
+    const std::uint32_t* row = draw_row(0);
+    for (int col = 0; col < info.target_w; ++col) {
+        out[col] = row[scaler->col_start[col]];
+    }
+    return true;
+}
+
+int v5img_byte(V5ImgReader* reader) {
+    if (reader->pos == reader->len) {
+        reader->len = std::fread(reader->buf, 1, sizeof(reader->buf), reader->file);
+        reader->pos = 0;
+        if (reader->len == 0) {
+            return -1;
+        }
+    }
+    return reader->buf[reader->pos++];
+}
+
+std::uint32_t qoi_add(std::uint32_t px, int dr, int dg, int db) {
+    const std::uint32_t r = ((px >> 16) + dr) & 0xFF;
+    const std::uint32_t g = ((px >> 8) + dg) & 0xFF;
+    const std::uint32_t b = (px + db) & 0xFF;
+    return (r << 16) | (g << 8) | b;
+}
+
+// Rows whose pixels are split by the per-channel tables: 16-bit, and 32-bit bitfields.
+void convert_channel_row(const BmpInfo& info, const std::uint8_t* row, std::uint32_t* out, int bytes) {
+    const std::uint32_t* red = info.lut.data() + info.channel_base[0];
+    const std::uint32_t* green = info.lut.data() + info.channel_base[1];
+    const std::uint32_t* blue = info.lut.data() + info.channel_base[2];
+    for (int col = 0; col < info.width; ++col, row += bytes) {
+        const std::uint32_t value = bytes == 2 ? read_le16(row) : read_le32(row);
+        out[col] = red[(value >> info.channel_shift[0]) & info.channel_mask[0]] |
+                   green[(value >> info.channel_shift[1]) & info.channel_mask[1]] |
+                   blue[(value >> info.channel_shift[2]) & info.channel_mask[2]];
+    }
+}
+}  // namespace
+
+bool read_bmp_info(FILE* file, BmpInfo* info) {
+    // File header, BITMAPINFOHEADER and the three BI_BITFIELDS masks that follow it (or
+    // sit at the same offset inside a V4/V5 header).
+    std::uint8_t header[66] = {};
+    if (std::fread(header, 1, 54, file) != 54 || header[0] != 'B' || header[1] != 'M') {
+        return false;
+    }
+
+    const std::uint32_t data_offset = read_le32(&header[10]);
+    const std::uint32_t dib_size = read_le32(&header[14]);
+    const std::int32_t width = static_cast<std::int32_t>(read_le32(&header[18]));
+    const std::int32_t height = static_cast<std::int32_t>(read_le32(&header[22]));
+    const std::uint16_t bpp = read_le16(&header[28]);
+    const std::uint32_t compression = read_le32(&header[30]);
+    const std::uint32_t colors_used = read_le32(&header[46]);
+
+    const bool bpp_ok = bpp == 1 || bpp == 4 || bpp == 8 || bpp == 16 || bpp == 24 || bpp == 32;
+    const bool compression_ok = (compression == 0) || (compression == 3 && (bpp == 16 || bpp == 32));
+    if (!bpp_ok || !compression_ok || dib_size < 40 || width <= 0 || height == 0) {
+        return false;
+    }
+
+    info->data_offset = data_offset;
+    info->width = width;
+    info->rows = std::abs(height);
+    info->top_down = height < 0;
+    info->bits_per_pixel = bpp;
+    info->row_size = ((static_cast<std::uint32_t>(bpp) * width + 31) / 32) * 4;
+    info->lut.clear();
+
+    if (bpp <= 8) {
+        const std::uint32_t entries = 1u << bpp;
+        const std::uint32_t stored = (colors_used == 0 || colors_used > entries) ? entries : colors_used;
+        std::uint8_t palette[256 * 4];
+        std::fseek(file, static_cast<long>(14 + dib_size), SEEK_SET);
+        if (std::fread(palette, 4, stored, file) != stored) {
+            return false;
+        }
+        info->lut.assign(entries, 0);
+        for (std::uint32_t idx = 0; idx < stored; ++idx) {
+            const std::uint8_t* bgrx = &palette[idx * 4];
+            info->lut[idx] = (static_cast<std::uint32_t>(bgrx[2]) << 16) |
+                             (static_cast<std::uint32_t>(bgrx[1]) << 8) | bgrx[0];
+        }
+    } else if (bpp == 16 || compression == 3) {
+        // BI_RGB 16-bit is RGB555; BI_RGB 32-bit (and bitfields that say the same) is BGRX
+        // and keeps the direct byte path below.
+        std::uint32_t masks[3] = {0x7C00, 0x03E0, 0x001F};
+        if (compression == 3) {
+            std::fseek(file, 54, SEEK_SET);
+            if (std::fread(&header[54], 1, 12, file) != 12) {
+                return false;
+            }
+            for (int channel = 0; channel < 3; ++channel) {
+                masks[channel] = read_le32(&header[54 + 4 * channel]);
+            }
+        }
+        const bool bgrx = bpp == 32 && masks[0] == 0x00FF0000 && masks[1] == 0x0000FF00 && masks[2] == 0x000000FF;
+        for (int channel = 0; channel < 3 && !bgrx; ++channel) {
+            if (!add_channel_table(info, channel, masks[channel])) {
+                return false;
+            }
+        }
+    }
+
+    info->scaled = width > kScreenW || info->rows > kScreenH;
+    info->target_w = width;
+    info->target_h = info->rows;
+    info->offset_x = 0;
+    info->offset_y = 0;
+    if (info->scaled) {
+        const std::int64_t w = width;
+        const std::int64_t h = info->rows;
+        if (w * kScreenH >= h * kScreenW) {
+            info->target_w = kScreenW;
+            info->target_h = static_cast<int>(std::max<std::int64_t>(1, (h * kScreenW + w / 2) / w));
+        } else {
+            info->target_h = kScreenH;
+            info->target_w = static_cast<int>(std::max<std::int64_t>(1, (w * kScreenH + h / 2) / h));
+        }
+        info->offset_x = (kScreenW - info->target_w) / 2;
+        info->offset_y = (kScreenH - info->target_h) / 2;
+    }
+    return true;
+}
+
+void convert_bmp_row(const BmpInfo& info, const std::uint8_t* row, std::uint32_t* out) {
+    const std::uint32_t* lut = info.lut.data();
+    const int width = info.width;
+    switch (info.bits_per_pixel) {
+    case 1:
+        for (int col = 0; col < width; ++col) {
+            out[col] = lut[(row[col >> 3] >> (7 - (col & 7))) & 1];
+        }
+        break;
+    case 4:
+        for (int col = 0; col < width; ++col) {
+            out[col] = lut[(row[col >> 1] >> ((col & 1) ? 0 : 4)) & 0x0F];
+        }
+        break;
+    case 8:
+        for (int col = 0; col < width; ++col) {
+            out[col] = lut[row[col]];
+        }
+        break;
+    case 16:
+        convert_channel_row(info, row, out, 2);
+        break;
+    case 32:
+        if (!info.lut.empty()) {  // bitfields in some order other than BGRX
+            convert_channel_row(info, row, out, 4);
+            break;
+        }
+        [[fallthrough]];
+    default: {
+        const std::uint32_t step = info.bits_per_pixel / 8;
+        for (int col = 0; col < width; ++col, row += step) {
+            out[col] = (static_cast<std::uint32_t>(row[2]) << 16) |
+                       (static_cast<std::uint32_t>(row[1]) << 8) |
+                       static_cast<std::uint32_t>(row[0]);
+        }
+        break;
+    }
+    }
+}
+
+bool parse_scale_filter(const char* text, ScaleFilter* out) {
+    for (std::size_t idx = 0; idx < sizeof(kScaleFilterNames) / sizeof(kScaleFilterNames[0]); ++idx) {
+        const char* name = kScaleFilterNames[idx];
+        std::size_t len = 0;
+        while (name[len] && std::toupper(static_cast<unsigned char>(text[len])) == name[len]) {
+            ++len;
+        }
+        if (name[len] == '\0' && text[len] == '\0') {
+            *out = static_cast<ScaleFilter>(idx);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool draw_bmp_streaming(FILE* file, const BmpInfo& info, int x, int y, ScaleFilter filter) {
+    std::vector<std::uint32_t> row_buf(static_cast<std::size_t>(info.target_w));
+    x += info.offset_x;
+    y += info.offset_y;
+
+    if (info.scaled) {
+        BmpScaler scaler;
+        init_bmp_scaler(info, filter, &scaler);
+        for (int ty = 0; ty < info.target_h; ++ty) {
+            if (!scale_bmp_row(file, info, &scaler, ty, row_buf.data())) {
+                break;
+            }
+            const std::int16_t y_row = static_cast<std::int16_t>(y + ty);
+            pros::screen::copy_area(x, y_row, static_cast<std::int16_t>(x + info.target_w - 1), y_row,
+                                    row_buf.data(), info.target_w);
+        }
+        return true;
+    }
+
+    std::vector<std::uint8_t> row(info.row_size);
+    std::fseek(file, static_cast<long>(info.data_offset), SEEK_SET);
+    for (std::int32_t row_idx = 0; row_idx < info.rows; ++row_idx) {
+        if (std::fread(row.data(), 1, info.row_size, file) != info.row_size) {
+            break;
+        }
+        convert_bmp_row(info, row.data(), row_buf.data());
+        const std::int16_t y_row = static_cast<std::int16_t>(y + (info.top_down ? row_idx : info.rows - 1 - row_idx));
+        pros::screen::copy_area(x, y_row, static_cast<std::int16_t>(x + info.target_w - 1), y_row, row_buf.data(),
+                                info.target_w);
+    }
+    return true;
+}
+
+bool decode_bmp_frame(FILE* file, const BmpInfo& info, std::uint32_t* frame, ScaleFilter filter) {
+    if (info.scaled) {
+        BmpScaler scaler;
+        init_bmp_scaler(info, filter, &scaler);
+        for (int ty = 0; ty < info.target_h; ++ty) {
+            if (!scale_bmp_row(file, info, &scaler, ty, frame + static_cast<std::size_t>(ty) * info.target_w)) {
+                break;
+            }
+        }
+        return true;
+    }
+
+    const std::size_t chunk_rows = std::max<std::size_t>(1, kBmpChunkBytes / info.row_size);
+    std::unique_ptr<std::uint8_t[]> chunk(new (std::nothrow) std::uint8_t[chunk_rows * info.row_size]);
+    if (!chunk) {
+        return false;
+    }
+    std::fseek(file, static_cast<long>(info.data_offset), SEEK_SET);
+    for (std::int32_t first = 0; first < info.rows;) {
+        const std::size_t want = std::min<std::size_t>(chunk_rows, static_cast<std::size_t>(info.rows - first));
+        const std::size_t got = std::fread(chunk.get(), info.row_size, want, file);
+        for (std::size_t idx = 0; idx < got; ++idx) {
+            const std::int32_t row_idx = first + static_cast<std::int32_t>(idx);
+            const std::int32_t draw_y = info.top_down ? row_idx : (info.rows - 1 - row_idx);
+            convert_bmp_row(info, chunk.get() + idx * info.row_size,
+                            frame + static_cast<std::size_t>(draw_y) * info.target_w);
+        }
+        if (got < want) {
+            break;
+        }
+        first += static_cast<std::int32_t>(got);
+    }
+    return true;
+}
+
+bool draw_bmp_fast(FILE* file, const BmpInfo& info, int x, int y, ScaleFilter filter) {
+    const std::size_t pixels = static_cast<std::size_t>(info.target_w) * info.target_h;
+    std::unique_ptr<std::uint32_t[]> frame(new (std::nothrow) std::uint32_t[pixels]());
+    if (!frame || !decode_bmp_frame(file, info, frame.get(), filter)) {
+        return false;
+    }
+    x += info.offset_x;
+    y += info.offset_y;
+    pros::screen::copy_area(x,
+                            y,
+                            static_cast<std::int16_t>(x + info.target_w - 1),
+                            static_cast<std::int16_t>(y + info.target_h - 1),
+                            frame.get(),
+                            info.target_w);
+    return true;
+}
+
+bool read_v5img_info(FILE* file, V5ImgInfo* info) {
+    std::uint8_t header[kV5ImgHeaderBytes];
+    if (std::fread(header, 1, sizeof(header), file) != sizeof(header) ||
+        std::memcmp(header, kV5ImgMagic, sizeof(kV5ImgMagic)) != 0) {
+        return false;
+    }
+    std::uint16_t version = 0;
+    std::uint16_t width = 0;
+    std::uint16_t height = 0;
+    std::memcpy(&version, &header[4], sizeof(version));
+    std::memcpy(&width, &header[6], sizeof(width));
+    std::memcpy(&height, &header[8], sizeof(height));
+    std::memcpy(&info->encoding, &header[10], sizeof(info->encoding));
+    std::memcpy(&info->data_offset, &header[12], sizeof(info->data_offset));
+    if (version != kV5ImgVersion || width == 0 || height == 0 || width > kScreenW || height > kScreenH ||
+        info->encoding > kV5ImgQoi || info->data_offset < kV5ImgHeaderBytes) {
+        return false;
+    }
+    info->width = width;
+    info->height = height;
+    return true;
+}
+
+void v5img_reader_start(V5ImgReader* reader, FILE* file, const V5ImgInfo& info) {
+    reader->file = file;
+    reader->encoding = info.encoding;
+    reader->pos = 0;
+    reader->len = 0;
+    std::fill(std::begin(reader->index), std::end(reader->index), 0u);
+    reader->px = 0;
+    reader->run = 0;
+    std::fseek(file, static_cast<long>(info.data_offset), SEEK_SET);
+}
+
+std::size_t v5img_read(V5ImgReader* reader, std::uint32_t* out, std::size_t count) {
+    if (reader->encoding == kV5ImgRaw) {
+        return std::fread(out, sizeof(std::uint32_t), count, reader->file);
+    }
+
+    std::size_t produced = 0;
+    while (produced < count) {
+        if (reader->run > 0) {
+            --reader->run;
+            out[produced++] = reader->px;
+            continue;
+        }
+        const int op = v5img_byte(reader);
+        if (op < 0) {
+            break;
+        }
+        if (op == 0xFE || op == 0xFF) {  // RGB, or RGBA with the alpha ignored
+            const int r = v5img_byte(reader);
+            const int g = v5img_byte(reader);
+            const int b = v5img_byte(reader);
+            if (op == 0xFF) {
+                v5img_byte(reader);
+            }
+            if (b < 0) {
+                break;
+            }
+            reader->px = (static_cast<std::uint32_t>(r) << 16) | (static_cast<std::uint32_t>(g) << 8) |
+                         static_cast<std::uint32_t>(b);
+        } else if ((op >> 6) == 0) {
+            reader->px = reader->index[op];
+        } else if ((op >> 6) == 1) {
+            reader->px = qoi_add(reader->px, ((op >> 4) & 3) - 2, ((op >> 2) & 3) - 2, (op & 3) - 2);
+        } else if ((op >> 6) == 2) {
+            const int next = v5img_byte(reader);
+            if (next < 0) {
+                break;
+            }
+            const int dg = (op & 0x3F) - 32;
+            reader->px = qoi_add(reader->px, dg + ((next >> 4) & 0x0F) - 8, dg, dg + (next & 0x0F) - 8);
+        } else {
+            reader->run = op & 0x3F;
+        }
+        const std::uint32_t r = reader->px >> 16;
+        const std::uint32_t g = (reader->px >> 8) & 0xFF;
+        const std::uint32_t b = reader->px & 0xFF;
+        reader->index[(r * 3 + g * 5 + b * 7 + 255 * 11) % 64] = reader->px;
+        out[produced++] = reader->px;
+    }
+    return produced;
+}
+
+bool draw_v5img(FILE* file, const V5ImgInfo& info, int x, int y) {
+    std::unique_ptr<V5ImgReader> reader(new (std::nothrow) V5ImgReader());
+    int band_rows = info.encoding == kV5ImgRaw ? info.height : std::min(info.height, kV5ImgBandRows);
+    std::unique_ptr<std::uint32_t[]> band(
+        new (std::nothrow) std::uint32_t[static_cast<std::size_t>(band_rows) * info.width]());
+    std::vector<std::uint32_t> row;
+    std::uint32_t* pixels = band.get();
+    if (!pixels) {
+        band_rows = 1;
+        row.resize(static_cast<std::size_t>(info.width));
+        pixels = row.data();
+    }
+    if (!reader) {
+        return false;
+    }
+    v5img_reader_start(reader.get(), file, info);
+
+    for (int first = 0; first < info.height; first += band_rows) {
+        const int rows = std::min(band_rows, info.height - first);
+        const std::size_t want = static_cast<std::size_t>(rows) * info.width;
+        const std::size_t got = v5img_read(reader.get(), pixels, want);
+        if (got < want) {
+            std::fill(pixels + got, pixels + want, 0u);
+        }
+        pros::screen::copy_area(x,
+                                static_cast<std::int16_t>(y + first),
+                                static_cast<std::int16_t>(x + info.width - 1),
+                                static_cast<std::int16_t>(y + first + rows - 1),
+                                pixels,
+                                info.width);
+        if (got < want) {
+            break;
+        }
+    }
+    return true;
+}
+
+std::string v5img_sibling(const std::string& name) {
+    const std::size_t slash = name.find_last_of('/');
+    const std::size_t dot = name.find_last_of('.');
+    const std::size_t stem_end = (dot != std::string::npos && (slash == std::string::npos || dot > slash))
+                                     ? dot
+                                     : name.size();
+    return name.substr(0, stem_end) + kV5ImgExt;
+}
+
+bool ends_with_v5img(const std::string& name) {
+    const std::size_t ext_len = sizeof(kV5ImgExt) - 1;
+    if (name.size() < ext_len) {
+        return false;
+    }
+    for (std::size_t i = 0; i < ext_len; ++i) {
+        if (std::tolower(static_cast<unsigned char>(name[name.size() - ext_len + i])) != kV5ImgExt[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace image_codec
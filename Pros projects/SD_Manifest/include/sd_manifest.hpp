@@ -0,0 +1,78 @@
+#pragma once
+
+// Index of the files on the SD card, shared by every project.
+//
+// /usd/sd_manifest.txt holds one "seq,size,path" line per image, log, plan and config
+// file in the card root, Images/ and Images/.thumbs/. Programs append a line whenever they finish
+// writing a file (the newest line for a path wins), so selectors and loaders read one
+// small file instead of calling pros::usd::list_files on every directory. seq is a
+// card-wide counter that stands in for the mtime FAT does not give us.
+//
+// The index is built by one directory scan the first time a card is seen without it,
+// on an explicit rebuild() (Image Selector's RESCAN), or on the PC with
+// tools/sd_manifest.py after copying images over.
+//
+// Built into each project by SD_Manifest/manifest.mk.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace sd_manifest {
+
+constexpr char kPath[] = "/usd/sd_manifest.txt";
+
+struct Entry {
+    std::string path;  // full "/usd/..." path as it was written
+    std::uint32_t size = 0;
+    std::uint32_t seq = 0;
+};
+
+// True when the card is mounted; replaces the old list_files("/") mount probe.
+bool card_present();
+
+// Reads the manifest into memory. False when the card or the file is missing.
+bool load();
+// Lists the card root, Images/ and Images/.thumbs/ once and rewrites the manifest from scratch.
+// Returns the number of files indexed, or -1 without a card.
+int rebuild();
+// load(), falling back to rebuild() the first time a card has no manifest.
+bool ensure_loaded();
+bool loaded();
+
+// Records a finished write. size < 0 measures the file with one fopen.
+void note(const char* path, long size = -1);
+// ftell + fclose + note for a file opened for writing.
+void close_and_note(FILE* file, const char* path);
+
+// Copies of the entries under dir ("/usd/" or "/usd/Images/", not recursive) whose
+// names start with prefix and end with suffix (both case-insensitive, may be null),
+// oldest first.
+std::vector<Entry> find(const char* dir, const char* prefix, const char* suffix);
+// True when path (any "/usd/" spelling, case-insensitive) is indexed.
+bool contains(const char* path);
+// contains() that also copies the entry out (e.g. to compare seq with another file).
+bool lookup(const char* path, Entry* out);
+std::size_t count();
+
+// Path resolver shared by the projects (src/sd_open.cpp). Names may be bare, "usd/...",
+// "/usd/..." or "Images/..."; a bare name is looked for in the card root, then Images/.
+//
+// Learns which root holds each name from the manifest. open() calls this on first use;
+// call it from initialize() to pay for it up front.
+void probe_layout();
+// True when the layout probe saw the file name (directories ignored) in any root, so
+// callers can skip opening files that are not on the card.
+bool known(const char* name);
+// fopen on the root the probe found, one pass over the roots for names it did not see,
+// and the old retrying prefix walk while the card has not answered. Files opened for
+// writing land in the card root unless the name pins Images/.
+FILE* open(const char* name, const char* mode);
+// close_and_note() for a file open() created, under the root it picked.
+void close_written(FILE* file, const char* name);
+// fopen and mount probes the old prefix walk would have spent on the opens so far.
+std::uint32_t probes_saved();
+
+}  // namespace sd_manifest
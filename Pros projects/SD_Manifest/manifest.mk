@@ -0,0 +1,15 @@
+# Shared SD card manifest (SD_Manifest). Included from the Makefile of every project,
+# and by Bonkers_Recorder/recorder.mk since the recorder indexes its logs; the guard
+# keeps the objects from being added twice.
+ifndef MANIFEST_DIR
+MANIFEST_DIR:=$(ROOT)/../SD_Manifest
+MANIFEST_SRC:=$(wildcard $(MANIFEST_DIR)/src/*.cpp)
+MANIFEST_OBJ:=$(patsubst $(MANIFEST_DIR)/src/%,$(BINDIR)/manifest/%.o,$(MANIFEST_SRC))
+
+EXTRA_INCDIR+=$(MANIFEST_DIR)/include
+ELF_DEPS+=$(MANIFEST_OBJ)
+
+$(BINDIR)/manifest/%.cpp.o: $(MANIFEST_DIR)/src/%.cpp $(wildcard $(MANIFEST_DIR)/include/*.hpp)
+	$(VV)mkdir -p $(dir $@)
+	$(call test_output_2,Compiled $< ,$(CXX) -c $(INCLUDE) $(CXXFLAGS) $(EXTRA_CXXFLAGS) -o $@ $<,$(OK_STRING))
+endif
@@ -0,0 +1,299 @@
+#include "sd_manifest.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include "api.h"
+
+namespace sd_manifest {
+namespace {
+constexpr const char* kScanDirs[] = {"/", "/Images", "/Images/.thumbs"};
+constexpr const char* kScanRoots[] = {"/usd/", "/usd/Images/", "/usd/Images/.thumbs/"};
+constexpr std::size_t kListBytes = 16384;
+// Rewrite the file once superseded lines outnumber live entries by this much.
+constexpr std::size_t kCompactSlack = 32;
+
+std::vector<Entry> g_entries;
+std::uint32_t g_next_seq = 1;
+std::size_t g_file_lines = 0;
+bool g_loaded = false;
+pros::Mutex g_mutex;
+
+bool iequals_prefix(const char* str, const char* prefix) {
+    for (; *prefix; ++str, ++prefix) {
+        if (std::tolower(static_cast<unsigned char>(*str)) != std::tolower(static_cast<unsigned char>(*prefix))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool iends_with(const std::string& str, const char* suffix) {
+    const std::size_t len = std::strlen(suffix);
+    return str.size() >= len && iequals_prefix(str.c_str() + str.size() - len, suffix);
+}
+
+bool same_path(const std::string& a, const std::string& b) {
+    return a.size() == b.size() && iequals_prefix(a.c_str(), b.c_str());
+}
+
+// "usd/x", "/usd/x" and bare "x" all become "/usd/x".
+std::string normalize(const char* path) {
+    if (iequals_prefix(path, "/usd/")) {
+        return std::string(path);
+    }
+    if (iequals_prefix(path, "usd/")) {
+        return std::string("/") + path;
+    }
+    return std::string("/usd/") + (path[0] == '/' ? path + 1 : path);
+}
+
+long measure(const char* path) {
+    FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        return -1;
+    }
+    std::fseek(file, 0, SEEK_END);
+    const long size = std::ftell(file);
+    std::fclose(file);
+    return size;
+}
+
+Entry* find_entry(const std::string& path) {
+    for (Entry& entry : g_entries) {
+        if (same_path(entry.path, path)) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+void upsert(const std::string& path, std::uint32_t size, std::uint32_t seq) {
+    Entry* entry = find_entry(path);
+    if (!entry) {
+        g_entries.push_back({path, size, seq});
+        entry = &g_entries.back();
+    }
+    entry->size = size;
+    entry->seq = seq;
+    g_next_seq = std::max(g_next_seq, seq + 1);
+}
+
+bool write_all_locked() {
+    FILE* file = std::fopen(kPath, "w");
+    if (!file) {
+        return false;
+    }
+    std::fprintf(file, "# seq,size,path\n");
+    for (const Entry& entry : g_entries) {
+        std::fprintf(file, "%u,%u,%s\n", static_cast<unsigned>(entry.seq),
+                     static_cast<unsigned>(entry.size), entry.path.c_str());
+    }
+    std::fclose(file);
+    g_file_lines = g_entries.size();
+    return true;
+}
+
+bool load_locked() {
+    g_entries.clear();
+    g_next_seq = 1;
+    g_file_lines = 0;
+    g_loaded = false;
+    FILE* file = std::fopen(kPath, "r");
+    if (!file) {
+        return false;
+    }
+    char line[192];
+    while (std::fgets(line, sizeof(line), file)) {
+        line[std::strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '#' || line[0] == '\0') {
+            continue;
+        }
+        char* end = nullptr;
+        const unsigned long seq = std::strtoul(line, &end, 10);
+        if (*end != ',') {
+            continue;
+        }
+        const unsigned long size = std::strtoul(end + 1, &end, 10);
+        if (*end != ',' || end[1] == '\0') {
+            continue;
+        }
+        upsert(normalize(end + 1), static_cast<std::uint32_t>(size), static_cast<std::uint32_t>(seq));
+        ++g_file_lines;
+    }
+    std::fclose(file);
+    g_loaded = true;
+
+    if (g_file_lines > g_entries.size() * 2 + kCompactSlack) {
+        write_all_locked();
+    }
+    return true;
+}
+
+int rebuild_locked() {
+    g_entries.clear();
+    g_next_seq = 1;
+    g_loaded = false;
+    if (!card_present()) {
+        return -1;
+    }
+
+    std::vector<char> listing(kListBytes);
+    for (std::size_t dir = 0; dir < sizeof(kScanDirs) / sizeof(kScanDirs[0]); ++dir) {
+        std::fill(listing.begin(), listing.end(), '\0');
+        errno = 0;
+        if (pros::usd::list_files(kScanDirs[dir], listing.data(), static_cast<int>(listing.size() - 1)) == PROS_ERR) {
+            continue;
+        }
+        char* name = listing.data();
+        while (name && *name) {
+            char* next = std::strchr(name, '\n');
+            if (next) {
+                *next++ = '\0';
+            }
+            name[std::strcspn(name, "\r")] = '\0';
+            const char* base = std::strrchr(name, '/');
+            base = base ? base + 1 : name;
+            const std::string path = std::string(kScanRoots[dir]) + base;
+            // Every tracked file has an extension; this skips Images/ and other folders
+            // without an fopen.
+            const long size = std::strchr(base, '.') ? measure(path.c_str()) : -1;
+            if (size >= 0 && !same_path(path, kPath)) {
+                upsert(path, static_cast<std::uint32_t>(size), g_next_seq);
+            }
+            name = next;
+        }
+    }
+
+    g_loaded = write_all_locked();
+    return static_cast<int>(g_entries.size());
+}
+
+bool ensure_loaded_locked() {
+    return g_loaded || load_locked() || rebuild_locked() >= 0;
+}
+}  // namespace
+
+bool card_present() {
+    return pros::usd::is_installed() == 1;
+}
+
+bool load() {
+    g_mutex.take();
+    const bool ok = card_present() && load_locked();
+    g_mutex.give();
+    return ok;
+}
+
+int rebuild() {
+    g_mutex.take();
+    const int indexed = rebuild_locked();
+    g_mutex.give();
+    return indexed;
+}
+
+bool ensure_loaded() {
+    g_mutex.take();
+    const bool ok = card_present() && ensure_loaded_locked();
+    g_mutex.give();
+    return ok;
+}
+
+bool loaded() {
+    return g_loaded;
+}
+
+void note(const char* path, long size) {
+    if (!path || !*path) {
+        return;
+    }
+    const std::string full = normalize(path);
+    if (same_path(full, kPath)) {
+        return;
+    }
+    if (size < 0) {
+        size = measure(full.c_str());
+        if (size < 0) {
+            return;
+        }
+    }
+
+    g_mutex.take();
+    if (ensure_loaded_locked()) {
+        const std::uint32_t seq = g_next_seq;
+        upsert(full, static_cast<std::uint32_t>(size), seq);
+        FILE* file = std::fopen(kPath, "a");
+        if (file) {
+            std::fprintf(file, "%u,%u,%s\n", static_cast<unsigned>(seq), static_cast<unsigned>(size), full.c_str());
+            std::fclose(file);
+            ++g_file_lines;
+        }
+    }
+    g_mutex.give();
+}
+
+void close_and_note(FILE* file, const char* path) {
+    if (!file) {
+        return;
+    }
+    std::fflush(file);
+    const long size = std::ftell(file);
+    std::fclose(file);
+    note(path, size);
+}
+
+std::vector<Entry> find(const char* dir, const char* prefix, const char* suffix) {
+    std::vector<Entry> out;
+    const std::string root = normalize(dir ? dir : "");
+    g_mutex.take();
+    for (const Entry& entry : g_entries) {
+        if (!iequals_prefix(entry.path.c_str(), root.c_str())) {
+            continue;
+        }
+        const char* name = entry.path.c_str() + root.size();
+        if (*name == '\0' || std::strchr(name, '/')) {
+            continue;
+        }
+        if ((prefix && !iequals_prefix(name, prefix)) || (suffix && !iends_with(entry.path, suffix))) {
+            continue;
+        }
+        out.push_back(entry);
+    }
+    g_mutex.give();
+    std::sort(out.begin(), out.end(), [](const Entry& a, const Entry& b) { return a.seq < b.seq; });
+    return out;
+}
+
+bool contains(const char* path) {
+    if (!path || !*path) {
+        return false;
+    }
+    const std::string full = normalize(path);
+    g_mutex.take();
+    const bool found = find_entry(full) != nullptr;
+    g_mutex.give();
+    return found;
+}
+
+bool lookup(const char* path, Entry* out) {
+    if (!path || !*path) {
+        return false;
+    }
+    const std::string full = normalize(path);
+    g_mutex.take();
+    const Entry* entry = find_entry(full);
+    if (entry && out) {
+        *out = *entry;
+    }
+    g_mutex.give();
+    return entry != nullptr;
+}
+
+std::size_t count() {
+    return g_entries.size();
+}
+
+}  // namespace sd_manifest
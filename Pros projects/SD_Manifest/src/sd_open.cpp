@@ -0,0 +1,254 @@
+#include "sd_manifest.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#include "api.h"
+
+// Path resolver behind sd_manifest::open(). Kept apart from the manifest file handling;
+// it only reads the manifest to learn which root holds each name.
+
+namespace sd_manifest {
+namespace {
+// Roots open() tries, in the order the old prefix walk reached them. The manifest
+// indexes the first two; FAT treats Images/ and images/ as the same directory.
+constexpr const char* kRoots[] = {"/usd/", "/usd/Images/", "/usd/images/"};
+constexpr int kRootCount = 3;
+constexpr int kIndexedRoots = 2;
+// Position of each root in the old prefix list; a hit there cost a raw fopen, a
+// list_files mount probe and (position + 1) prefixed fopens.
+constexpr std::uint32_t kLegacyPrefixPos[] = {0, 2, 3};
+// A file the old walk never found: 3 attempts x (raw fopen + mount probe + 6 prefixes).
+constexpr std::uint32_t kLegacyMissProbes = 3 * (1 + 1 + 6);
+
+struct CacheEntry {
+    std::string key;  // lower-case file name; FAT names are case-insensitive
+    int root;
+};
+
+// Which root holds each file, filled once by probe_layout() and kept current as open()
+// finds or creates files.
+struct PathCache {
+    bool probed = false;
+    bool mounted = false;
+    std::vector<CacheEntry> entries;
+    std::uint32_t probes_saved = 0;
+};
+
+PathCache g_cache;
+pros::Mutex g_cache_mutex;
+
+bool starts_with(const char* str, const char* prefix) {
+    return std::strncmp(str, prefix, std::strlen(prefix)) == 0;
+}
+
+std::string name_key(const char* name) {
+    std::string key = name ? name : "";
+    for (char& ch : key) {
+        ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+    }
+    return key;
+}
+
+const char* base_name(const char* name) {
+    const char* slash = std::strrchr(name, '/');
+    return slash ? slash + 1 : name;
+}
+
+int cached_root(const std::string& key) {
+    for (const CacheEntry& entry : g_cache.entries) {
+        if (entry.key == key) {
+            return entry.root;
+        }
+    }
+    return -1;
+}
+
+void remember(const std::string& key, int root) {
+    for (CacheEntry& entry : g_cache.entries) {
+        if (entry.key == key) {
+            entry.root = root;
+            return;
+        }
+    }
+    g_cache.entries.push_back({key, root});
+}
+
+// The first root holding a name wins, matching the old search order.
+void probe_layout_locked() {
+    g_cache.entries.clear();
+    g_cache.mounted = ensure_loaded();
+    if (g_cache.mounted) {
+        for (int root = 0; root < kIndexedRoots; ++root) {
+            for (const Entry& file : find(kRoots[root], nullptr, nullptr)) {
+                const std::string key = name_key(base_name(file.path.c_str()));
+                if (cached_root(key) < 0) {
+                    g_cache.entries.push_back({key, root});
+                }
+            }
+        }
+    }
+    g_cache.probed = true;
+}
+
+// Original prefix walk with retries; only used while the card has not answered a probe.
+FILE* open_search(const char* name, const char* mode) {
+    const char* prefixes[] = {
+        "/usd/",
+        "usd/",
+        "/usd/Images/",
+        "/usd/images/",
+        "usd/Images/",
+        "usd/images/",
+    };
+
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        FILE* file = std::fopen(name, mode);
+        if (file) {
+            return file;
+        }
+
+        if (starts_with(name, "usd/")) {
+            char fixed[128];
+            std::snprintf(fixed, sizeof(fixed), "/%s", name);
+            file = std::fopen(fixed, mode);
+            if (file) {
+                return file;
+            }
+        }
+
+        card_present();
+
+        char path[128];
+        for (const char* prefix : prefixes) {
+            std::snprintf(path, sizeof(path), "%s%s", prefix, name);
+            file = std::fopen(path, mode);
+            if (file) {
+                return file;
+            }
+        }
+
+        pros::delay(50);
+    }
+
+    return nullptr;
+}
+
+FILE* open_locked(const char* name, const char* mode) {
+    if (!g_cache.probed) {
+        probe_layout_locked();
+    }
+    if (!g_cache.mounted) {
+        FILE* file = open_search(name, mode);
+        if (file) {
+            g_cache.probed = false;  // card is up now; probe again on the next open
+        }
+        return file;
+    }
+
+    // Accept bare names, "usd/..." and "/usd/..."; Images/<name> pins the root.
+    const char* rel = name;
+    if (starts_with(rel, "/usd/")) {
+        rel += 5;
+    } else if (starts_with(rel, "usd/")) {
+        rel += 4;
+    }
+    int hint = -1;
+    if (name_key(rel).compare(0, 7, "images/") == 0) {
+        rel += 7;
+        hint = 1;
+    }
+    if (std::strchr(rel, '/')) {
+        char path[128];
+        std::snprintf(path, sizeof(path), "/usd/%s", rel);
+        return std::fopen(path, mode);
+    }
+
+    const std::string key = name_key(rel);
+    const bool writing = mode[0] == 'w' || mode[0] == 'a';
+    const int cached = cached_root(key);
+    char path[128];
+    if (writing || cached >= 0) {
+        const int root = hint >= 0 ? hint : (cached >= 0 ? cached : 0);
+        std::snprintf(path, sizeof(path), "%s%s", kRoots[root], rel);
+        FILE* file = std::fopen(path, mode);
+        if (file) {
+            remember(key, root);
+            if (hint < 0 && rel == name) {
+                g_cache.probes_saved += 1 + kLegacyPrefixPos[root];
+            }
+            return file;
+        }
+        if (writing) {
+            return nullptr;
+        }
+    }
+
+    // Not in the listing (or the listing was truncated): one pass over the roots, no
+    // retries or sleeps.
+    std::uint32_t tries = 0;
+    for (int root = 0; root < kRootCount; ++root) {
+        if (hint >= 0 && root != hint) {
+            continue;
+        }
+        std::snprintf(path, sizeof(path), "%s%s", kRoots[root], rel);
+        ++tries;
+        FILE* file = std::fopen(path, mode);
+        if (file) {
+            remember(key, root);
+            return file;
+        }
+    }
+    g_cache.probes_saved += kLegacyMissProbes - std::min(tries, kLegacyMissProbes);
+    return nullptr;
+}
+}  // namespace
+
+void probe_layout() {
+    g_cache_mutex.take();
+    probe_layout_locked();
+    g_cache_mutex.give();
+}
+
+bool known(const char* name) {
+    if (!name) {
+        return false;
+    }
+    g_cache_mutex.take();
+    if (!g_cache.probed) {
+        probe_layout_locked();
+    }
+    const bool found = cached_root(name_key(base_name(name))) >= 0;
+    g_cache_mutex.give();
+    return found;
+}
+
+FILE* open(const char* name, const char* mode) {
+    if (!name || !mode) {
+        return nullptr;
+    }
+    g_cache_mutex.take();
+    FILE* file = open_locked(name, mode);
+    g_cache_mutex.give();
+    return file;
+}
+
+void close_written(FILE* file, const char* name) {
+    if (!file || !name) {
+        return;
+    }
+    const char* base = base_name(name);
+    g_cache_mutex.take();
+    const int root = cached_root(name_key(base));
+    g_cache_mutex.give();
+    char path[128];
+    std::snprintf(path, sizeof(path), "%s%s", kRoots[root < 0 ? 0 : root], base);
+    close_and_note(file, path);
+}
+
+std::uint32_t probes_saved() {
+    return g_cache.probes_saved;
+}
+
+}  // namespace sd_manifest
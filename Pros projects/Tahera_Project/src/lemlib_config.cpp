@@ -4,15 +4,24 @@
 
 #include <vector>
 
-const lemlib::PID angular_pid(0.05, 0.0, 0.0);
-const lemlib::PID lateral_pid(0.05, 0.0, 0.0);
+// Starting gains worked out from the drive, to be tuned on the field. The motions feed
+// lateral error in metres and angular error in radians, and want motor power from -1 to
+// 1 back. 3.25 in wheels at 360 rpm top out near 1.56 m/s; spinning in place at full
+// power turns about 10.7 rad/s on the 11.5 in track.
+// - lateral: full power from about 0.3 m (12 in) out; kD takes roughly a quarter of the
+//   power back at top speed so the robot does not coast through the target.
+// - angular: full power from about 0.67 rad (38 deg) out, kD likewise.
+const lemlib::PID angular_pid(1.5, 0.0, 0.025);
+const lemlib::PID lateral_pid(3.3, 0.0, 0.16);
 
 const std::function<units::Pose()> pose_getter = [] {
     return units::Pose(0_in, 0_in, 0_stDeg);
 };
 
-lemlib::MotorGroup left_motors({-1, 2, -3}, 360_rpm);
-lemlib::MotorGroup right_motors({4, -5, 6}, 360_rpm);
+// Same ports as left_drive/left_middle and right_drive/right_middle in main.cpp. Motion
+// steps use these with 6WD on and main.cpp's outer-motor groups with it off.
+lemlib::MotorGroup left_motors({-6, -1, 2}, 360_rpm);
+lemlib::MotorGroup right_motors({10, 7, -9}, 360_rpm);
 
 const lemlib::ExitConditionGroup<AngleRange> angular_exit_conditions(
     std::vector<lemlib::ExitCondition<AngleRange>>{lemlib::ExitCondition<AngleRange>(1_stDeg, 200_msec)});
@@ -1,14 +1,49 @@
 #include "main.h"
+#include "sd_manifest.hpp"
+#include "image_codec.hpp"
+#include "bonkers_recorder.hpp"
+#include "auton_steps.hpp"
+#include "lemlib/MotionHandler.hpp"
+#include "lemlib/motions/follow.hpp"
+#include "lemlib/motions/moveToPoint.hpp"
+#include "lemlib/motions/moveToPose.hpp"
+#include "lemlib/motions/turnTo.hpp"
 #include <algorithm>
 #include <cstddef>
 #include <cerrno>
 #include <cstdint>
 #include <cstdio>
+#include <cstdlib>
 #include <string>
 #include <cmath>
 #include <vector>
 #include <cstring>
 #include <cctype>
+#include <memory>
+#include <new>
+
+#ifndef EMBED_JERKBOT
+#define EMBED_JERKBOT 0
+#endif
+#if EMBED_JERKBOT
+#include "hot-cold-asset/asset.hpp"
+ASSET(jerkbot_v5img)
+#endif
+
+using image_codec::BmpInfo;
+using image_codec::ScaleFilter;
+using image_codec::V5ImgInfo;
+using image_codec::V5ImgReader;
+using image_codec::decode_bmp_frame;
+using image_codec::draw_bmp_streaming;
+using image_codec::draw_v5img;
+using image_codec::ends_with_v5img;
+using image_codec::parse_scale_filter;
+using image_codec::read_bmp_info;
+using image_codec::read_v5img_info;
+using image_codec::v5img_read;
+using image_codec::v5img_reader_start;
+using image_codec::v5img_sibling;
 
 namespace {
 constexpr char kLoadingIconName[] = "loading_icon.bmp";
@@ -23,58 +58,6 @@ bool starts_with(const char* str, const char* prefix) {
     const std::size_t prefix_len = std::strlen(prefix);
     return std::strncmp(str, prefix, prefix_len) == 0;
 }
-
-bool try_mount_sd() {
-    char buffer[64] = {0};
-    errno = 0;
-    return pros::usd::list_files("/", buffer, sizeof(buffer)) != PROS_ERR;
-}
-
-FILE* sd_open(const char* name, const char* mode) {
-    if (!name || !mode) {
-        return nullptr;
-    }
-
-    const char* prefixes[] = {
-        "/usd/",
-        "usd/",
-        "/usd/Images/",
-        "/usd/images/",
-        "usd/Images/",
-        "usd/images/",
-    };
-
-    for (int attempt = 0; attempt < 3; ++attempt) {
-        FILE* file = std::fopen(name, mode);
-        if (file) {
-            return file;
-        }
-
-        if (starts_with(name, "usd/")) {
-            char fixed[128];
-            std::snprintf(fixed, sizeof(fixed), "/%s", name);
-            file = std::fopen(fixed, mode);
-            if (file) {
-                return file;
-            }
-        }
-
-        try_mount_sd();
-
-        char path[128];
-        for (const char* prefix : prefixes) {
-            std::snprintf(path, sizeof(path), "%s%s", prefix, name);
-            file = std::fopen(path, mode);
-            if (file) {
-                return file;
-            }
-        }
-
-        pros::delay(50);
-    }
-
-    return nullptr;
-}
 }
 
 // ======================================================
@@ -87,6 +70,10 @@ pros::MotorGroup left_drive({-6, -1}, pros::v5::MotorGears::blue);
 pros::MotorGroup right_drive({10, 7}, pros::v5::MotorGears::blue);
 pros::Motor left_middle(2, pros::v5::MotorGears::blue);
 pros::Motor right_middle(-9, pros::v5::MotorGears::blue);
+// LemLib groups of the outer motors only, for motion steps while 6WD is off
+// (left_motors/right_motors in lemlib_config.cpp include the middle pair).
+lemlib::MotorGroup left_outer_motors({-6, -1}, 360_rpm);
+lemlib::MotorGroup right_outer_motors({10, 7}, 360_rpm);
 
 pros::Motor intake(13, pros::v5::MotorGears::blue);
 pros::Motor outake(12, pros::v5::MotorGears::blue);
@@ -112,23 +99,53 @@ constexpr char kSlot1File[] = "auton_plans_slot1.txt";
 constexpr char kSlot2File[] = "auton_plans_slot2.txt";
 constexpr char kSlot3File[] = "auton_plans_slot3.txt";
 constexpr char kSlotIndexFile[] = "auton_slot.txt";
+constexpr char kAutonProfilePath[] = "/usd/auton_profile.txt";
 constexpr char kControllerMappingFile[] = "controller_mapping.txt";
 static int g_active_slot = 0;
 constexpr char kUiConfigName[] = "ui_images.txt";
 constexpr char kDefaultSplash[] = "loading_icon.bmp";
 constexpr char kDefaultRun[] = "jerkbot.bmp";
+constexpr char kEmbeddedJerkbot[] = "jerkbot.v5img";
+constexpr std::size_t kImageCacheDefaultKb = 1536;  // about three full-screen images
+// How images larger than the screen are shrunk (SCALE_FILTER= in ui_images.txt).
+ScaleFilter g_scale_filter = ScaleFilter::BOX;
 constexpr int kAutonMaxMs = 15000;
+// Longest an auton wait sleeps before rechecking the abort flag.
+constexpr std::uint32_t kAutonTickMs = 10;
+// Largest change in a drive command per kAutonTickMs when one auton drive step hands
+// over to the next. 0 switches set-points at once, which replays a recording exactly;
+// 8 would spread a full reversal over about 300 ms.
+constexpr int kAutonSlewPerTick = 0;
+// WAIT_FOR thresholds: a motor below kStoppedRpm counts as stopped, and an intake
+// drawing more than kStallCurrentMa while stopped counts as stalled.
+constexpr double kStoppedRpm = 5.0;
+constexpr std::int32_t kStallCurrentMa = 2000;
+// Odometry for the motion steps: drive wheel size and wheel turns per motor turn (360 rpm
+// wheels on blue motors, as in lemlib_config.cpp).
+constexpr double kWheelDiameterIn = 3.25;
+constexpr double kDriveGearRatio = 360.0 / 600.0;
+constexpr std::uint32_t kOdomPeriodMs = 10;
+// FOLLOW_PATH lookahead when the step gives none.
+constexpr int kDefaultLookaheadIn = 10;
+constexpr char kAutonPathFormat[] = "auton_path_%d.txt";
 std::string g_splash_image = kDefaultSplash;
 std::string g_auton_image = kDefaultRun;
 std::string g_driver_image;
 std::string g_run_image = kDefaultRun;
 bool g_ui_locked = false;
+// Serializes screen drawing between the UI task, opcontrol and auton; held while a
+// full-screen image or the selection UI is painted.
+pros::Mutex g_ui_mutex;
+// Set whenever something other than draw_brain_ui() paints the screen, so the next
+// draw_brain_ui() clears it and repaints every widget instead of only the changed ones.
+bool g_ui_full_redraw = true;
 bool g_force_driver_image = false;
 bool g_show_selection_ui = true;
 std::uint32_t g_last_ui_ms = 0;
 std::uint32_t g_auton_end_ms = 0;
 bool g_auton_abort = false;
 constexpr std::uint32_t kSelectionUiTimeoutMs = 5000;
+constexpr std::uint32_t kUiRefreshMs = 250;
 
 enum class DriveControlMode {
     TANK = 0,
@@ -138,13 +155,40 @@ enum class DriveControlMode {
 
 static DriveControlMode g_drive_mode = DriveControlMode::TANK;
 
-constexpr char kRecordLogPrefix[] = "/usd/bonkers_log_";
-constexpr int kRecordFlushThreshold = 25;
-static bool g_drive_recording = false;
-static FILE* g_record_file = nullptr;
-static std::string g_record_path;
-static std::vector<std::string> g_record_buffer;
-pros::Mutex g_record_mutex;
+// Indexed by bit position; the order is also the decoder's Tahera button table.
+enum RecordButtonBit : std::uint16_t {
+    kRecBtnIntakeIn = 1u << 0,
+    kRecBtnIntakeOut = 1u << 1,
+    kRecBtnOutakeOut = 1u << 2,
+    kRecBtnOutakeIn = 1u << 3,
+    kRecBtnGpsEnable = 1u << 4,
+    kRecBtnGpsDisable = 1u << 5,
+    kRecBtnSixOn = 1u << 6,
+    kRecBtnSixOff = 1u << 7,
+    kRecBtnDpadUp = 1u << 8,
+    kRecBtnDpadDown = 1u << 9,
+    kRecBtnDpadLeft = 1u << 10,
+    kRecBtnDpadRight = 1u << 11
+};
+
+constexpr recorder::ButtonName kRecordButtonNames[] = {
+    {"BTN_INTAKE_IN", "INTAKE_IN"},
+    {"BTN_INTAKE_OUT", "INTAKE_OUT"},
+    {"BTN_OUTAKE_OUT", "OUTAKE_OUT"},
+    {"BTN_OUTAKE_IN", "OUTAKE_IN"},
+    {"BTN_GPS_ENABLE", "GPS_ENABLE"},
+    {"BTN_GPS_DISABLE", "GPS_DISABLE"},
+    {"BTN_SIX_ON", "SIX_WHEEL_ON"},
+    {"BTN_SIX_OFF", "SIX_WHEEL_OFF"},
+    {"BTN_DPAD_UP", "DPAD_UP"},
+    {"BTN_DPAD_DOWN", "DPAD_DOWN"},
+    {"BTN_DPAD_LEFT", "DPAD_LEFT"},
+    {"BTN_DPAD_RIGHT", "DPAD_RIGHT"},
+};
+
+// Order matches the MOTOR index field and the TELEM line columns.
+constexpr const char* kTelemetryMotorNames[] = {"LD", "RD", "LM", "RM", "IN", "OUT"};
+constexpr std::size_t kTelemetryMotorCount = sizeof(kTelemetryMotorNames) / sizeof(kTelemetryMotorNames[0]);
 
 enum class ControllerAction {
     INTAKE_IN = 0,
@@ -239,135 +283,256 @@ bool parse_drive_mode(const std::string& key, DriveControlMode* out_mode) {
     return false;
 }
 
-enum class StepType {
-    EMPTY,
-    DRIVE_MS,
-    TANK_MS,
-    TURN_HEADING,
-    WAIT_MS,
-    INTAKE_ON,
-    INTAKE_OFF,
-    OUTTAKE_ON,
-    OUTTAKE_OFF
-};
-
-struct Step {
-    StepType type;
-    int value1;
-    int value2;
-    int value3;
-};
+using auton_steps::Step;
+using auton_steps::StepType;
 
 static std::vector<Step> gps_plan_sd;
 static std::vector<Step> basic_plan_sd;
+// Run when the SD card has no plan for the selected mode.
+const std::vector<Step> kFallbackPlan = {
+    {StepType::DRIVE_MS, 60, 1500, 0},
+    {StepType::WAIT_MS, 100, 0, 0},
+    {StepType::TURN_HEADING, 90, 0, 0},
+    {StepType::DRIVE_MS, -40, 500, 0},
+};
+// Step timings of the last auton run, written to kAutonProfilePath afterwards.
+std::vector<auton_steps::StepTiming> g_auton_profile;
+// FOLLOW_PATH paths (auton_path_N.txt, path.jerryio's LemLib format) used by the loaded
+// plans, read with the plans so auton never waits on the card.
+struct AutonPath {
+    int number = 0;
+    std::vector<std::uint8_t> data;
+};
+std::vector<AutonPath> g_auton_paths;
+
+bool turn_toward_heading(double target, int max_speed);
+
+// Screen-ready copy of a BMP: 0x00RRGGBB pixels, already scaled down to fit the screen
+// and drawn offset_x/offset_y in so scaled images stay centred.
+struct DecodedImage {
+    std::string key;
+    int width = 0;
+    int height = 0;
+    int offset_x = 0;
+    int offset_y = 0;
+    std::unique_ptr<std::uint32_t[]> pixels;
+    std::uint32_t last_used = 0;
+};
 
-void turn_to_heading(double target, int max_speed);
-void run_simple_auton_fallback();
+// Decoded images keyed by path, evicted least-recently-drawn first once the total pixel
+// memory passes the budget (IMAGE_CACHE_KB in ui_images.txt). Filled in initialize() and
+// competition_initialize() so the auton/driver/splash switches are a single blit.
+struct ImageCache {
+    std::vector<DecodedImage> images;
+    std::size_t bytes = 0;
+    std::size_t budget = kImageCacheDefaultKb * 1024;
+    std::uint32_t clock = 0;
+    std::uint32_t hits = 0;
+    std::uint32_t misses = 0;
+};
 
-bool draw_bmp_from_sd(const char* name, int x, int y) {
-    FILE* file = sd_open(name, "rb");
-    if (!file) {
+ImageCache g_image_cache;
+pros::Mutex g_image_cache_mutex;
+
+// Decodes (and, for oversized images, scales) the BMP straight into out. Returns false
+// when the buffers cannot be allocated; the caller then streams the file.
+bool decode_bmp(FILE* file, const BmpInfo& info, DecodedImage* out) {
+    const std::size_t pixels = static_cast<std::size_t>(info.target_w) * info.target_h;
+    out->pixels.reset(new (std::nothrow) std::uint32_t[pixels]());
+    if (!out->pixels || !decode_bmp_frame(file, info, out->pixels.get(), g_scale_filter)) {
+        out->pixels.reset();
         return false;
     }
+    out->width = info.target_w;
+    out->height = info.target_h;
+    out->offset_x = info.offset_x;
+    out->offset_y = info.offset_y;
+    return true;
+}
 
-    std::uint8_t header[54];
-    if (std::fread(header, 1, sizeof(header), file) != sizeof(header)) {
-        std::fclose(file);
+bool decode_v5img(FILE* file, const V5ImgInfo& info, DecodedImage* out) {
+    const std::size_t pixels = static_cast<std::size_t>(info.width) * info.height;
+    std::unique_ptr<V5ImgReader> reader(new (std::nothrow) V5ImgReader());
+    out->pixels.reset(new (std::nothrow) std::uint32_t[pixels]());
+    if (!out->pixels || !reader) {
+        out->pixels.reset();
         return false;
     }
+    out->width = info.width;
+    out->height = info.height;
+    v5img_reader_start(reader.get(), file, info);
+    v5img_read(reader.get(), out->pixels.get(), pixels);
+    return true;
+}
 
-    const std::uint32_t data_offset = *reinterpret_cast<std::uint32_t*>(&header[10]);
-    const std::int32_t width = *reinterpret_cast<std::int32_t*>(&header[18]);
-    const std::int32_t height = *reinterpret_cast<std::int32_t*>(&header[22]);
-    const std::uint16_t bpp = *reinterpret_cast<std::uint16_t*>(&header[28]);
-    const std::uint32_t compression = *reinterpret_cast<std::uint32_t*>(&header[30]);
+// The jerkbot image built into the program (static/jerkbot.v5img via the hot/cold asset
+// rules), opened as a read-only stream so the .v5img code can draw it. Only asked for
+// when the card has no copy; nullptr for other names or when built with EMBED_JERKBOT=0.
+FILE* open_embedded_image(const char* name) {
+#if EMBED_JERKBOT
+    const char* base = std::strrchr(name, '/');
+    std::string native = v5img_sibling(base ? base + 1 : name);
+    for (char& c : native) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    if (native == kEmbeddedJerkbot) {
+        return fmemopen(jerkbot_v5img.buf, jerkbot_v5img.size, "rb");
+    }
+#else
+    (void)name;
+#endif
+    return nullptr;
+}
 
-    const bool compression_ok = (compression == 0) || (compression == 3 && bpp == 32);
-    if ((bpp != 24 && bpp != 32) || !compression_ok || width <= 0 || height == 0) {
-        std::fclose(file);
+bool load_embedded_image(const char* name, DecodedImage* out, bool* streamed, int x, int y) {
+    FILE* file = open_embedded_image(name);
+    if (!file) {
         return false;
     }
+    V5ImgInfo info;
+    bool decoded = false;
+    if (read_v5img_info(file, &info)) {
+        decoded = decode_v5img(file, info, out);
+        if (!decoded && streamed) {
+            *streamed = draw_v5img(file, info, x, y);
+        }
+    }
+    std::fclose(file);
+    return decoded;
+}
 
-    const bool top_down = height < 0;
-    const std::int32_t abs_height = std::abs(height);
-    const std::uint32_t bytes_per_pixel = bpp / 8;
-    const std::uint32_t row_size = ((bytes_per_pixel * width + 3) / 4) * 4;
-    const int max_w = 480;
-    const int max_h = 240;
-    int target_w = width;
-    int target_h = abs_height;
-    bool scale = false;
-    if (width > max_w || abs_height > max_h) {
-        target_w = std::min(static_cast<int>(width), max_w);
-        target_h = std::min(static_cast<int>(abs_height), max_h);
-        scale = true;
+// Decodes name into out, preferring a .v5img sibling the layout probe saw. When memory
+// is too short to decode, a caller that passes streamed gets the file streamed to the
+// screen at x, y instead; false is returned either way.
+bool load_image_file(const char* name, DecodedImage* out, bool* streamed, int x, int y) {
+    const std::string native = ends_with_v5img(name) ? std::string(name) : v5img_sibling(name);
+    if (sd_manifest::known(native.c_str())) {
+        FILE* file = sd_manifest::open(native.c_str(), "rb");
+        V5ImgInfo info;
+        if (file && read_v5img_info(file, &info)) {
+            const bool decoded = decode_v5img(file, info, out);
+            if (!decoded && streamed) {
+                *streamed = draw_v5img(file, info, x, y);
+            }
+            std::fclose(file);
+            return decoded;
+        }
+        if (file) {
+            std::fclose(file);
+        }
     }
 
-    std::vector<std::uint8_t> row(row_size);
-    std::vector<std::uint32_t> row_buf(static_cast<std::size_t>(target_w));
+    FILE* file = sd_manifest::open(name, "rb");
+    if (!file) {
+        return load_embedded_image(name, out, streamed, x, y);
+    }
+    BmpInfo info;
+    bool decoded = false;
+    if (read_bmp_info(file, &info)) {
+        decoded = decode_bmp(file, info, out);
+        if (!decoded && streamed) {
+            *streamed = draw_bmp_streaming(file, info, x, y, g_scale_filter);
+        }
+    }
+    std::fclose(file);
+    return decoded;
+}
 
-    std::fseek(file, static_cast<long>(data_offset), SEEK_SET);
+void blit_image(const DecodedImage& image, int x, int y) {
+    x += image.offset_x;
+    y += image.offset_y;
+    pros::screen::copy_area(static_cast<std::int16_t>(x),
+                            static_cast<std::int16_t>(y),
+                            static_cast<std::int16_t>(x + image.width - 1),
+                            static_cast<std::int16_t>(y + image.height - 1),
+                            image.pixels.get(),
+                            image.width);
+}
 
-    int last_target_row = -1;
-    for (std::int32_t row_idx = 0; row_idx < abs_height; ++row_idx) {
-        if (std::fread(row.data(), 1, row_size, file) != row_size) {
-            break;
-        }
+std::size_t image_bytes(const DecodedImage& image) {
+    return static_cast<std::size_t>(image.width) * image.height * sizeof(std::uint32_t);
+}
 
-        const std::int32_t draw_y = top_down ? row_idx : (abs_height - 1 - row_idx);
-
-        if (!scale) {
-            for (std::int32_t col = 0; col < width; ++col) {
-                const std::size_t idx = static_cast<std::size_t>(col * bytes_per_pixel);
-                const std::uint8_t b = row[idx];
-                const std::uint8_t g = row[idx + 1];
-                const std::uint8_t r = row[idx + 2];
-                row_buf[static_cast<std::size_t>(col)] = (static_cast<std::uint32_t>(r) << 16) |
-                                                         (static_cast<std::uint32_t>(g) << 8) |
-                                                         static_cast<std::uint32_t>(b);
-            }
+void image_cache_trim_locked(std::size_t incoming) {
+    while (!g_image_cache.images.empty() && g_image_cache.bytes + incoming > g_image_cache.budget) {
+        auto oldest = std::min_element(g_image_cache.images.begin(), g_image_cache.images.end(),
+                                       [](const DecodedImage& a, const DecodedImage& b) {
+                                           return a.last_used < b.last_used;
+                                       });
+        g_image_cache.bytes -= image_bytes(*oldest);
+        g_image_cache.images.erase(oldest);
+    }
+}
 
-            const std::int16_t y_row = static_cast<std::int16_t>(y + draw_y);
-            pros::screen::copy_area(x,
-                                    y_row,
-                                    static_cast<std::int16_t>(x + width - 1),
-                                    y_row,
-                                    row_buf.data(),
-                                    width);
-            continue;
-        }
+// Cache key for an image name; FAT names are case-insensitive.
+std::string image_key(const char* name) {
+    std::string key = name ? name : "";
+    for (char& ch : key) {
+        ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+    }
+    return key;
+}
 
-        const int target_row = (draw_y * target_h) / abs_height;
-        if (target_row == last_target_row) {
-            continue;
-        }
-        last_target_row = target_row;
-
-        for (int col = 0; col < target_w; ++col) {
-            const int src_x = (col * width) / target_w;
-            const std::size_t idx = static_cast<std::size_t>(src_x * bytes_per_pixel);
-            const std::uint8_t b = row[idx];
-            const std::uint8_t g = row[idx + 1];
-            const std::uint8_t r = row[idx + 2];
-            row_buf[static_cast<std::size_t>(col)] = (static_cast<std::uint32_t>(r) << 16) |
-                                                     (static_cast<std::uint32_t>(g) << 8) |
-                                                     static_cast<std::uint32_t>(b);
+// Returns the cached image for name, decoding it on a miss. Images bigger than the whole
+// budget are decoded into scratch and not kept. When memory is too short to decode, a
+// caller that passes streamed gets the file streamed to the screen at x, y instead.
+const DecodedImage* image_cache_get_locked(const char* name, DecodedImage* scratch, bool* streamed,
+                                           int x = 0, int y = 0) {
+    const std::string key = image_key(name);
+    for (DecodedImage& image : g_image_cache.images) {
+        if (image.key == key) {
+            image.last_used = ++g_image_cache.clock;
+            ++g_image_cache.hits;
+            return &image;
         }
+    }
 
-        const std::int16_t y_row = static_cast<std::int16_t>(y + target_row);
-        if (y_row < 0 || y_row >= max_h) {
-            continue;
-        }
-        pros::screen::copy_area(x,
-                                y_row,
-                                static_cast<std::int16_t>(x + target_w - 1),
-                                y_row,
-                                row_buf.data(),
-                                target_w);
+    ++g_image_cache.misses;
+    if (!load_image_file(name, scratch, streamed, x, y)) {
+        return nullptr;
     }
 
-    std::fclose(file);
-    return true;
+    scratch->key = key;
+    scratch->last_used = ++g_image_cache.clock;
+    const std::size_t bytes = image_bytes(*scratch);
+    if (bytes > g_image_cache.budget) {
+        return scratch;
+    }
+    image_cache_trim_locked(bytes);
+    g_image_cache.bytes += bytes;
+    g_image_cache.images.push_back(std::move(*scratch));
+    return &g_image_cache.images.back();
+}
+
+void image_cache_set_budget(std::size_t budget_bytes) {
+    g_image_cache_mutex.take();
+    g_image_cache.budget = budget_bytes;
+    image_cache_trim_locked(0);
+    g_image_cache_mutex.give();
+}
+
+// Decodes name into the cache without drawing it.
+bool image_cache_preload(const std::string& name) {
+    if (name.empty()) {
+        return false;
+    }
+    DecodedImage scratch;
+    g_image_cache_mutex.take();
+    const bool ok = image_cache_get_locked(name.c_str(), &scratch, nullptr) != nullptr;
+    g_image_cache_mutex.give();
+    return ok;
+}
+
+bool draw_bmp_from_sd(const char* name, int x, int y) {
+    DecodedImage scratch;
+    bool streamed = false;
+    g_image_cache_mutex.take();
+    const DecodedImage* image = image_cache_get_locked(name, &scratch, &streamed, x, y);
+    if (image) {
+        blit_image(*image, x, y);
+    }
+    g_image_cache_mutex.give();
+    return image != nullptr || streamed;
 }
 
 bool draw_loading_icon() {
@@ -458,7 +623,7 @@ void reset_controller_mapping_defaults() {
 void load_controller_mapping_from_sd() {
     reset_controller_mapping_defaults();
 
-    FILE* file = sd_open(kControllerMappingFile, "r");
+    FILE* file = sd_manifest::open(kControllerMappingFile, "r");
     if (!file) {
         return;
     }
@@ -526,8 +691,9 @@ void load_ui_images() {
     g_auton_image = coerce_images_path(kDefaultRun);
     g_driver_image.clear();
     g_run_image = g_auton_image;
+    g_scale_filter = ScaleFilter::BOX;
 
-    FILE* file = sd_open(kUiConfigName, "r");
+    FILE* file = sd_manifest::open(kUiConfigName, "r");
     if (!file) {
         return;
     }
@@ -547,6 +713,10 @@ void load_ui_images() {
         } else if (std::strncmp(line, "RUN=", 4) == 0) {
             legacy_run = line + 4;
             g_run_image = coerce_images_path(legacy_run);
+        } else if (std::strncmp(line, "IMAGE_CACHE_KB=", 15) == 0) {
+            image_cache_set_budget(static_cast<std::size_t>(std::max(0, std::atoi(line + 15))) * 1024);
+        } else if (std::strncmp(line, "SCALE_FILTER=", 13) == 0) {
+            parse_scale_filter(line + 13, &g_scale_filter);
         }
     }
 
@@ -558,93 +728,28 @@ void load_ui_images() {
     g_run_image = g_auton_image.empty() ? g_run_image : g_auton_image;
 }
 
-std::string make_record_log_path() {
-    char path[128];
-    std::snprintf(path, sizeof(path), "%s%u.txt", kRecordLogPrefix, pros::millis());
-    return std::string(path);
-}
-
-void record_flush_locked() {
-    if (!g_record_file || g_record_buffer.empty()) {
-        return;
-    }
-    for (const auto& line : g_record_buffer) {
-        std::fwrite(line.data(), 1, line.size(), g_record_file);
-    }
-    std::fflush(g_record_file);
-    g_record_buffer.clear();
-}
-
-void record_append_locked(const char* type, const char* value) {
-    if (!g_record_file || !type || !value) {
-        return;
-    }
-    char row[96];
-    const int written = std::snprintf(row, sizeof(row), "%s : %s\n", type, value);
-    if (written > 0) {
-        g_record_buffer.emplace_back(row, static_cast<std::size_t>(written));
+void load_record_config() {
+    FILE* file = sd_manifest::open(recorder::kConfigName, "r");
+    recorder::set_config(recorder::load_config(file));
+    if (file) {
+        std::fclose(file);
     }
 }
 
-void record_append_locked(const char* type, int value) {
-    char text[16];
-    std::snprintf(text, sizeof(text), "%d", value);
-    record_append_locked(type, text);
-}
-
 bool start_drive_recording() {
-    g_record_mutex.take();
-    if (g_drive_recording && g_record_file) {
-        g_record_mutex.give();
-        return true;
-    }
-
-    g_record_path = make_record_log_path();
-    g_record_file = sd_open(g_record_path.c_str(), "w");
-    if (!g_record_file) {
-        g_drive_recording = false;
-        g_record_path.clear();
-        g_record_mutex.give();
-        return false;
-    }
-
-    g_record_buffer.clear();
-    g_record_buffer.reserve(kRecordFlushThreshold);
-    g_drive_recording = true;
-    record_append_locked("REC_START", "TAHERA");
-    record_append_locked("DRIVE_MODE", drive_mode_key(g_drive_mode));
-    record_flush_locked();
-    g_record_mutex.give();
-    return true;
+    recorder::Session session;
+    session.program = recorder::Program::TAHERA;
+    session.program_name = "TAHERA";
+    session.drive_mode = static_cast<std::uint8_t>(g_drive_mode);
+    session.drive_mode_name = drive_mode_key(g_drive_mode);
+    session.buttons = kRecordButtonNames;
+    session.button_count = sizeof(kRecordButtonNames) / sizeof(kRecordButtonNames[0]);
+    session.motor_names = kTelemetryMotorNames;
+    return recorder::start(recorder::make_log_path().c_str(), session);
 }
 
 void stop_drive_recording(const char* reason) {
-    g_record_mutex.take();
-    if (!g_record_file) {
-        g_drive_recording = false;
-        g_record_mutex.give();
-        return;
-    }
-
-    if (reason && reason[0] != '\0') {
-        record_append_locked("REC_STOP", reason);
-    }
-    record_flush_locked();
-    std::fclose(g_record_file);
-    g_record_file = nullptr;
-    g_drive_recording = false;
-    g_record_mutex.give();
-}
-
-void record_status_snapshot(bool* active, std::string* path) {
-    g_record_mutex.take();
-    if (active) {
-        *active = g_drive_recording;
-    }
-    if (path) {
-        *path = g_record_path;
-    }
-    g_record_mutex.give();
+    recorder::stop(reason);
 }
 
 void record_drive_frame(int axis1,
@@ -663,53 +768,47 @@ void record_drive_frame(int axis1,
                         bool dpad_down_pressed,
                         bool dpad_left_pressed,
                         bool dpad_right_pressed) {
-    g_record_mutex.take();
-    if (!g_drive_recording || !g_record_file) {
-        g_record_mutex.give();
+    if (!recorder::is_recording()) {
         return;
     }
 
-    record_append_locked("AXIS1", axis1);
-    record_append_locked("AXIS2", axis2);
-    record_append_locked("AXIS3", axis3);
-    record_append_locked("AXIS4", axis4);
-
-    if (intake_in_pressed) record_append_locked("BTN_INTAKE_IN", "INTAKE_IN");
-    if (intake_out_pressed) record_append_locked("BTN_INTAKE_OUT", "INTAKE_OUT");
-    if (outake_out_pressed) record_append_locked("BTN_OUTAKE_OUT", "OUTAKE_OUT");
-    if (outake_in_pressed) record_append_locked("BTN_OUTAKE_IN", "OUTAKE_IN");
-    if (gps_enable_pressed) record_append_locked("BTN_GPS_ENABLE", "GPS_ENABLE");
-    if (gps_disable_pressed) record_append_locked("BTN_GPS_DISABLE", "GPS_DISABLE");
-    if (six_on_pressed) record_append_locked("BTN_SIX_ON", "SIX_WHEEL_ON");
-    if (six_off_pressed) record_append_locked("BTN_SIX_OFF", "SIX_WHEEL_OFF");
-    if (dpad_up_pressed) record_append_locked("BTN_DPAD_UP", "DPAD_UP");
-    if (dpad_down_pressed) record_append_locked("BTN_DPAD_DOWN", "DPAD_DOWN");
-    if (dpad_left_pressed) record_append_locked("BTN_DPAD_LEFT", "DPAD_LEFT");
-    if (dpad_right_pressed) record_append_locked("BTN_DPAD_RIGHT", "DPAD_RIGHT");
+    const int axes[4] = {axis1, axis2, axis3, axis4};
+    std::uint16_t buttons = 0;
+    if (intake_in_pressed) buttons |= kRecBtnIntakeIn;
+    if (intake_out_pressed) buttons |= kRecBtnIntakeOut;
+    if (outake_out_pressed) buttons |= kRecBtnOutakeOut;
+    if (outake_in_pressed) buttons |= kRecBtnOutakeIn;
+    if (gps_enable_pressed) buttons |= kRecBtnGpsEnable;
+    if (gps_disable_pressed) buttons |= kRecBtnGpsDisable;
+    if (six_on_pressed) buttons |= kRecBtnSixOn;
+    if (six_off_pressed) buttons |= kRecBtnSixOff;
+    if (dpad_up_pressed) buttons |= kRecBtnDpadUp;
+    if (dpad_down_pressed) buttons |= kRecBtnDpadDown;
+    if (dpad_left_pressed) buttons |= kRecBtnDpadLeft;
+    if (dpad_right_pressed) buttons |= kRecBtnDpadRight;
+    recorder::push_frame(axes, buttons);
+}
 
-    if (static_cast<int>(g_record_buffer.size()) >= kRecordFlushThreshold) {
-        record_flush_locked();
+// Called once per control tick right after record_drive_frame; samples the drivetrain,
+// mechanisms and IMU every TELEMETRY_MS.
+void record_telemetry_tick() {
+    if (!recorder::telemetry_due()) {
+        return;
     }
-    g_record_mutex.give();
+    const pros::AbstractMotor* motors[kTelemetryMotorCount] = {
+        &left_drive, &right_drive, &left_middle, &right_middle, &intake, &outake,
+    };
+    recorder::MotorSample samples[kTelemetryMotorCount];
+    for (std::size_t idx = 0; idx < kTelemetryMotorCount; ++idx) {
+        samples[idx] = recorder::sample_motor(*motors[idx], static_cast<std::uint8_t>(idx));
+    }
+    recorder::push_telemetry(imu.get_heading(), samples, kTelemetryMotorCount);
 }
 
 bool auton_time_up() {
     return g_auton_abort || (g_auton_end_ms != 0 && pros::millis() >= g_auton_end_ms);
 }
 
-bool delay_with_abort(int ms) {
-    const int chunk = 20;
-    int remaining = ms;
-    while (remaining > 0) {
-        if (auton_time_up()) {
-            return false;
-        }
-        pros::delay(std::min(chunk, remaining));
-        remaining -= chunk;
-    }
-    return true;
-}
-
 void drive_set(int left, int right) {
     left_drive.move(left);
     right_drive.move(right);
@@ -735,11 +834,257 @@ void stop_all_motors() {
     outake.brake();
 }
 
+void auton_intake(int power) {
+    if (power == 0) {
+        intake.brake();
+        outake.brake();
+    } else {
+        intake.move(power);
+        outake.move(power);
+    }
+}
+
+// WAIT_FOR conditions (auton_steps::Condition).
+bool auton_condition(int id) {
+    switch (id) {
+        case auton_steps::kDriveStopped:
+            return std::abs(left_drive.get_actual_velocity()) < kStoppedRpm &&
+                   std::abs(right_drive.get_actual_velocity()) < kStoppedRpm &&
+                   std::abs(left_middle.get_actual_velocity()) < kStoppedRpm &&
+                   std::abs(right_middle.get_actual_velocity()) < kStoppedRpm;
+        case auton_steps::kIntakeStalled:
+            return intake.get_current_draw() > kStallCurrentMa && std::abs(intake.get_actual_velocity()) < kStoppedRpm;
+        default:
+            return false;
+    }
+}
+
+// Robot pose from the drive encoders and the IMU: x/y in inches from where auton started,
+// heading in compass degrees. Written by the odometry task, read by the LemLib motions.
+struct OdomPose {
+    double x_in = 0.0;
+    double y_in = 0.0;
+    double heading_deg = 0.0;
+};
+pros::Mutex g_odom_mutex;
+OdomPose g_odom_pose;
+bool g_odom_rebase = true;  // next update takes new encoder/IMU baselines
+
+void odom_reset() {
+    g_odom_mutex.take();
+    g_odom_pose.x_in = 0.0;
+    g_odom_pose.y_in = 0.0;
+    g_odom_rebase = true;
+    g_odom_mutex.give();
+}
+
+units::Pose odom_pose() {
+    g_odom_mutex.take();
+    const OdomPose pose = g_odom_pose;
+    g_odom_mutex.give();
+    return units::Pose(from_in(pose.x_in), from_in(pose.y_in), from_cDeg(pose.heading_deg));
+}
+
+// Integrates the average drive travel along the IMU heading every kOdomPeriodMs. A
+// reading error (unplugged motor or IMU) skips the tick and rebases on the next one.
+void odom_task_fn(void*) {
+    constexpr double kInPerMotorDeg = kWheelDiameterIn * M_PI * kDriveGearRatio / 360.0;
+    constexpr double kDegToRad = M_PI / 180.0;
+    double last_left = 0.0;
+    double last_right = 0.0;
+    double last_rotation = 0.0;
+    std::uint32_t wake_ms = pros::millis();
+    while (true) {
+        const double left = left_drive.get_position();
+        const double right = right_drive.get_position();
+        const double rotation = imu.get_rotation();
+        const double heading = imu.get_heading();
+        g_odom_mutex.take();
+        if (!std::isfinite(left) || !std::isfinite(right) || !std::isfinite(rotation) || !std::isfinite(heading)) {
+            g_odom_rebase = true;
+        } else {
+            if (!g_odom_rebase) {
+                const double travel_in = ((left - last_left) + (right - last_right)) / 2.0 * kInPerMotorDeg;
+                // Standard-position angle halfway through the tick.
+                const double angle = (90.0 - (last_rotation + rotation) / 2.0) * kDegToRad;
+                g_odom_pose.x_in += travel_in * std::cos(angle);
+                g_odom_pose.y_in += travel_in * std::sin(angle);
+            }
+            g_odom_rebase = false;
+            g_odom_pose.heading_deg = heading;
+            last_left = left;
+            last_right = right;
+            last_rotation = rotation;
+        }
+        g_odom_mutex.give();
+        pros::Task::delay_until(&wake_ms, kOdomPeriodMs);
+    }
+}
+
+// Reads the path file of every FOLLOW_PATH step in the loaded plans.
+void load_auton_paths(const std::vector<Step>& plan) {
+    for (const Step& step : plan) {
+        if (step.type != StepType::FOLLOW_PATH) {
+            continue;
+        }
+        const bool loaded = std::any_of(g_auton_paths.begin(), g_auton_paths.end(),
+                                        [&](const AutonPath& path) { return path.number == step.value1; });
+        if (loaded) {
+            continue;
+        }
+        char name[32];
+        std::snprintf(name, sizeof(name), kAutonPathFormat, step.value1);
+        FILE* file = sd_manifest::open(name, "rb");
+        if (!file) {
+            continue;
+        }
+        AutonPath path;
+        path.number = step.value1;
+        std::uint8_t chunk[512];
+        std::size_t got = 0;
+        while ((got = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+            path.data.insert(path.data.end(), chunk, chunk + got);
+        }
+        std::fclose(file);
+        g_auton_paths.push_back(std::move(path));
+    }
+}
+
+// Plan step whose LemLib motion is running. The step engine gives the drive to one lane
+// at a time and counts motion steps as drive steps, so while a motion runs every drive,
+// turn or motion step in another lane waits for it.
+const Step* g_motion_step = nullptr;
+
+// Hands step to LemLib's motion task. False when it cannot run (FOLLOW_PATH without a
+// path file), which skips the step.
+bool start_motion(const Step& step) {
+    // Same 4/6-motor choice as drive_set; the idle middle pair is braked, not left coasting.
+    lemlib::MotorGroup* left = g_six_wheel_drive_enabled ? &left_motors : &left_outer_motors;
+    lemlib::MotorGroup* right = g_six_wheel_drive_enabled ? &right_motors : &right_outer_motors;
+    if (!g_six_wheel_drive_enabled) {
+        left_middle.brake();
+        right_middle.brake();
+    }
+    const Time timeout = from_msec(auton_steps::motion_timeout_ms(step));
+    const Number min_speed = step.min_speed / 127.0;
+    const Length exit_in = from_in(step.exit_range);
+    const units::V2Position target(from_in(step.value1), from_in(step.value2));
+    switch (step.type) {
+        case StepType::MOVE_TO_POINT:
+            lemlib::motion_handler::move([=] {
+                lemlib::moveToPoint(target, timeout, {.minLateralSpeed = min_speed, .earlyExitRange = exit_in},
+                                    {.poseGetter = odom_pose, .leftMotors = *left, .rightMotors = *right});
+            });
+            return true;
+        case StepType::MOVE_TO_POSE: {
+            const units::Pose pose(target.x, target.y, from_cDeg(step.value3));
+            lemlib::motion_handler::move([=] {
+                lemlib::moveToPose(pose, timeout, {.minLateralSpeed = min_speed, .earlyExitRange = exit_in},
+                                   {.poseGetter = odom_pose, .leftMotors = *left, .rightMotors = *right});
+            });
+            return true;
+        }
+        case StepType::TURN_TO_POINT: {
+            const AngleRange exit_deg = from_stDeg(step.exit_range);
+            lemlib::motion_handler::move([=] {
+                lemlib::turnTo(target, timeout, {.minSpeed = min_speed, .earlyExitRange = exit_deg},
+                               {.poseGetter = odom_pose, .leftMotors = *left, .rightMotors = *right});
+            });
+            return true;
+        }
+        case StepType::FOLLOW_PATH: {
+            const auto found = std::find_if(g_auton_paths.begin(), g_auton_paths.end(),
+                                            [&](const AutonPath& path) { return path.number == step.value1; });
+            if (found == g_auton_paths.end() || found->data.empty()) {
+                return false;
+            }
+            const asset path{found->data.data(), found->data.size()};
+            const Length lookahead = from_in(step.value2 > 0 ? step.value2 : kDefaultLookaheadIn);
+            lemlib::motion_handler::move([=] {
+                lemlib::follow(path, lookahead, timeout, {},
+                               {.poseGetter = odom_pose, .leftMotors = *left, .rightMotors = *right});
+            });
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+// Handler for the motion step types: starts the motion, then polls it every tick so
+// other lanes keep running. The engine has already given this lane the drive; the
+// isMoving() wait only covers a motion cancel_motion() could not stop in time.
+auton_steps::StepStatus run_motion_step(auton_steps::Run& run, auton_steps::Lane&, const Step& step) {
+    if (g_motion_step != &step) {
+        if (lemlib::motion_handler::isMoving()) {
+            return auton_steps::StepStatus::RUNNING;
+        }
+        if (!start_motion(step)) {
+            return auton_steps::StepStatus::DONE;
+        }
+        g_motion_step = &step;
+        run.drive_left = 0;  // the motion owns the drive now
+        run.drive_right = 0;
+        return auton_steps::StepStatus::RUNNING;
+    }
+    if (lemlib::motion_handler::isMoving()) {
+        return auton_steps::StepStatus::RUNNING;
+    }
+    g_motion_step = nullptr;
+    return auton_steps::StepStatus::DONE;
+}
+
+void register_motion_steps() {
+    auton_steps::set_handler(StepType::MOVE_TO_POINT, run_motion_step);
+    auton_steps::set_handler(StepType::MOVE_TO_POSE, run_motion_step);
+    auton_steps::set_handler(StepType::TURN_TO_POINT, run_motion_step);
+    auton_steps::set_handler(StepType::FOLLOW_PATH, run_motion_step);
+}
+
+// Stops a motion an aborted plan left running, before the motors are braked.
+void cancel_motion() {
+    lemlib::motion_handler::cancel();
+    for (int waited_ms = 0; lemlib::motion_handler::isMoving() && waited_ms < 50; waited_ms += 5) {
+        pros::delay(5);
+    }
+    g_motion_step = nullptr;
+}
+
+auton_steps::Hardware auton_hardware() {
+    auton_steps::Hardware hw;
+    hw.drive = drive_set;
+    hw.drive_stop = drive_brake;
+    hw.intake = auton_intake;
+    hw.turn_tick = turn_toward_heading;
+    hw.condition = auton_condition;
+    hw.should_abort = auton_time_up;
+    return hw;
+}
+
+// Replaces auton_profile.txt with the per-step start/end/overrun of the last run.
+void save_auton_profile() {
+    FILE* file = std::fopen(kAutonProfilePath, "w");
+    if (!file) {
+        return;
+    }
+    auton_steps::write_profile(file, g_auton_profile);
+    sd_manifest::close_and_note(file, kAutonProfilePath);
+}
+
+// Decodes every image the competition phases show, so switching views never reads SD.
+void preload_ui_images() {
+    image_cache_preload(g_splash_image);
+    image_cache_preload(g_auton_image.empty() ? g_run_image : g_auton_image);
+    image_cache_preload(g_driver_image);
+}
+
 bool draw_named_image(const std::string& name) {
     return draw_bmp_from_sd(name.c_str(), 0, 0);
 }
 
 void show_run_image_once() {
+    g_ui_mutex.take();
+    g_ui_full_redraw = true;
     pros::screen::set_pen(0x00000000);
     pros::screen::fill_rect(0, 0, 479, 239);
     const std::string& img = g_auton_image.empty() ? g_run_image : g_auton_image;
@@ -748,12 +1093,15 @@ void show_run_image_once() {
     pros::screen::fill_rect(0, 220, 479, 239);
     pros::screen::set_pen(pros::c::COLOR_WHITE);
     pros::screen::print(TEXT_MEDIUM, 10, 222, "auto");
+    g_ui_mutex.give();
 }
 
 void show_driver_image_once() {
     if (g_driver_image.empty()) {
         return;
     }
+    g_ui_mutex.take();
+    g_ui_full_redraw = true;
     pros::screen::set_pen(0x00000000);
     pros::screen::fill_rect(0, 0, 479, 239);
     draw_named_image(g_driver_image);
@@ -761,9 +1109,12 @@ void show_driver_image_once() {
     pros::screen::fill_rect(0, 220, 479, 239);
     pros::screen::set_pen(pros::c::COLOR_WHITE);
     pros::screen::print(TEXT_MEDIUM, 10, 222, "driving");
+    g_ui_mutex.give();
 }
 
 void show_init_splash() {
+    g_ui_mutex.take();
+    g_ui_full_redraw = true;
     pros::screen::set_pen(0x00000000);
     pros::screen::fill_rect(0, 0, 479, 239);
 
@@ -773,6 +1124,7 @@ void show_init_splash() {
         pros::screen::print(TEXT_MEDIUM, 10, 100, "SD image missing");
     }
     pros::screen::print(TEXT_MEDIUM, 10, 210, "thanks tahera :)");
+    g_ui_mutex.give();
 }
 
 struct Rect {
@@ -801,23 +1153,80 @@ std::string compact_ui_text(const std::string& value, std::size_t max_chars) {
     return value.substr(0, head) + "..." + value.substr(value.size() - tail);
 }
 
-void draw_brain_ui() {
-    pros::screen::set_pen(0x00000000);
-    pros::screen::fill_rect(0, 0, kScreenW - 1, kScreenH - 1);
+// Selection screen widgets. Each remembers the text and colour it last drew, so
+// draw_brain_ui() repaints only the rectangles whose state changed (a touch on GPS
+// touches two buttons and the AUTON line) instead of clearing the whole screen.
+enum UiWidgetId {
+    kUiGps = 0,
+    kUiBasic,
+    kUiRun,
+    kUiRec,
+    kUiAuton,
+    kUiSource,
+    kUiSd,
+    kUiSlot,
+    kUiDrive,
+    kUiRecState,
+    kUiFile,
+    kUiHelpDrive,
+    kUiHelpMech,
+    kUiFooter,
+    kUiWidgetCount
+};
 
-    const Rect gps_btn{10, 10, 140, 30};
-    const Rect basic_btn{170, 10, 140, 30};
-    const Rect run_btn{330, 10, 140, 30};
-    const Rect rec_btn{330, 50, 140, 30};
+struct UiLayout {
+    Rect rect;
+    bool button;  // outlined TEXT_MEDIUM button; otherwise one TEXT_SMALL line
+};
+
+// Text rects span their column so a shorter string clears the tail of the old one.
+constexpr UiLayout kUiLayout[kUiWidgetCount] = {
+    {{10, 10, 140, 30}, true},    {{170, 10, 140, 30}, true},  {{330, 10, 140, 30}, true},
+    {{330, 50, 140, 30}, true},   {{10, 74, 210, 16}, false},  {{10, 92, 210, 16}, false},
+    {{10, 110, 210, 16}, false},  {{10, 128, 210, 16}, false}, {{10, 146, 210, 16}, false},
+    {{10, 164, 210, 16}, false},  {{230, 74, 240, 16}, false},  {{230, 92, 240, 16}, false},
+    {{230, 110, 240, 16}, false}, {{10, 218, 460, 16}, false},
+};
+
+struct UiWidgetState {
+    std::string text;
+    std::uint32_t color = 0;
+    bool drawn = false;
+};
 
+UiWidgetState g_ui_widgets[kUiWidgetCount];
+
+// Caller holds g_ui_mutex.
+void ui_update_locked(UiWidgetId id, const char* text, std::uint32_t color) {
+    UiWidgetState& state = g_ui_widgets[id];
+    if (state.drawn && state.color == color && state.text == text) {
+        return;
+    }
+    const UiLayout& layout = kUiLayout[id];
+    const Rect& r = layout.rect;
+    if (state.drawn) {
+        pros::screen::set_pen(0x00000000);
+        pros::screen::fill_rect(r.x, r.y, r.x + r.w, r.y + r.h);
+    }
+    if (layout.button) {
+        draw_button(r, text, color);
+    } else {
+        pros::screen::set_pen(color);
+        pros::screen::print(TEXT_SMALL, r.x, r.y, "%s", text);
+    }
+    state.text = text;
+    state.color = color;
+    state.drawn = true;
+}
+
+// Brings the selection screen up to date. Cheap when nothing changed: it only formats
+// the strings and compares them with what is already on screen.
+void draw_brain_ui() {
     bool recording = false;
     std::string record_path;
-    record_status_snapshot(&recording, &record_path);
-
-    draw_button(gps_btn, "GPS", g_auton_mode == AutonMode::GPS_LEMLIB ? 0x0000FF00 : 0x00FFFFFF);
-    draw_button(basic_btn, "BASIC", g_auton_mode == AutonMode::NO_GPS ? 0x0000FF00 : 0x00FFFFFF);
-    draw_button(run_btn, g_auton_running ? "RUNNING" : "RUN", 0x00FF0000);
-    draw_button(rec_btn, recording ? "STOP REC" : "REC", recording ? 0x00FF0000 : 0x0000FF00);
+    std::uint32_t record_overruns = 0;
+    std::uint32_t telemetry_drops = 0;
+    recorder::status(&recording, &record_path, &record_overruns, &telemetry_drops);
 
     std::string display_file = "(none)";
     if (!record_path.empty()) {
@@ -826,27 +1235,57 @@ void draw_brain_ui() {
     }
     display_file = compact_ui_text(display_file, 22);
 
-    const int left_x = 10;
-    const int right_x = 230;
+    const bool gps = g_auton_mode == AutonMode::GPS_LEMLIB;
+    const std::uint32_t white = pros::c::COLOR_WHITE;
+    char line[64];
 
-    pros::screen::set_pen(pros::c::COLOR_WHITE);
-    pros::screen::print(TEXT_SMALL, left_x, 74, "AUTON: %s",
-                        g_auton_mode == AutonMode::GPS_LEMLIB ? "GPS" : "BASIC");
-    pros::screen::print(TEXT_SMALL, left_x, 92, "SOURCE: %s",
-                        g_sd_plans_loaded ? "SD" : "BUILT-IN");
-    pros::screen::print(TEXT_SMALL, left_x, 110, "SD: %s", g_sd_plans_loaded ? "OK" : "MISSING");
-    pros::screen::print(TEXT_SMALL, left_x, 128, "SLOT: %d", g_active_slot + 1);
-    pros::screen::print(TEXT_SMALL, left_x, 146, "DRIVE: %s", drive_mode_display(g_drive_mode));
-    pros::screen::print(TEXT_SMALL, left_x, 164, "REC: %s", recording ? "ON" : "OFF");
-    pros::screen::print(TEXT_SMALL, right_x, 74, "FILE: %s", display_file.c_str());
-    pros::screen::print(TEXT_SMALL, right_x, 92, "A/B GPS  Y/X 6WD");
-    pros::screen::print(TEXT_SMALL, right_x, 110, "L1/L2 intake  R1/R2 out");
-    pros::screen::print(TEXT_SMALL, 10, 218, "Tap RUN for auton / REC for driving log");
+    g_ui_mutex.take();
+    if (g_ui_full_redraw) {
+        pros::screen::set_pen(0x00000000);
+        pros::screen::fill_rect(0, 0, kScreenW - 1, kScreenH - 1);
+        for (UiWidgetState& state : g_ui_widgets) {
+            state.drawn = false;
+        }
+        g_ui_full_redraw = false;
+    }
+
+    ui_update_locked(kUiGps, "GPS", gps ? 0x0000FF00 : 0x00FFFFFF);
+    ui_update_locked(kUiBasic, "BASIC", !gps ? 0x0000FF00 : 0x00FFFFFF);
+    ui_update_locked(kUiRun, g_auton_running ? "RUNNING" : "RUN", 0x00FF0000);
+    ui_update_locked(kUiRec, recording ? "STOP REC" : "REC", recording ? 0x00FF0000 : 0x0000FF00);
+
+    std::snprintf(line, sizeof(line), "AUTON: %s", gps ? "GPS" : "BASIC");
+    ui_update_locked(kUiAuton, line, white);
+    std::snprintf(line, sizeof(line), "SOURCE: %s", g_sd_plans_loaded ? "SD" : "BUILT-IN");
+    ui_update_locked(kUiSource, line, white);
+    std::snprintf(line, sizeof(line), "SD: %s", g_sd_plans_loaded ? "OK" : "MISSING");
+    ui_update_locked(kUiSd, line, white);
+    std::snprintf(line, sizeof(line), "SLOT: %d", g_active_slot + 1);
+    ui_update_locked(kUiSlot, line, white);
+    std::snprintf(line, sizeof(line), "DRIVE: %s", drive_mode_display(g_drive_mode));
+    ui_update_locked(kUiDrive, line, white);
+    if (telemetry_drops > 0) {
+        std::snprintf(line, sizeof(line), "REC: %s  DROP: %u  TEL: %u", recording ? "ON" : "OFF",
+                      static_cast<unsigned>(record_overruns), static_cast<unsigned>(telemetry_drops));
+    } else if (record_overruns > 0) {
+        std::snprintf(line, sizeof(line), "REC: %s  DROP: %u", recording ? "ON" : "OFF",
+                      static_cast<unsigned>(record_overruns));
+    } else {
+        std::snprintf(line, sizeof(line), "REC: %s", recording ? "ON" : "OFF");
+    }
+    ui_update_locked(kUiRecState, line, white);
+    std::snprintf(line, sizeof(line), "FILE: %s", display_file.c_str());
+    ui_update_locked(kUiFile, line, white);
+    ui_update_locked(kUiHelpDrive, "A/B GPS  Y/X 6WD", white);
+    ui_update_locked(kUiHelpMech, "L1/L2 intake  R1/R2 out", white);
+    ui_update_locked(kUiFooter, "Tap RUN for auton / REC for driving log", white);
+    g_ui_mutex.give();
 }
 
 void brain_ui_loop() {
     draw_brain_ui();
     static int32_t last_release_count = -1;
+    std::uint32_t last_refresh_ms = pros::millis();
     while (true) {
         if (g_ui_locked) {
             pros::delay(200);
@@ -854,28 +1293,19 @@ void brain_ui_loop() {
         }
 
         pros::screen_touch_status_s_t status = pros::screen::touch_status();
-        if (status.touch_status == pros::E_TOUCH_RELEASED) {
-            if (status.release_count == last_release_count) {
-                pros::delay(50);
-                continue;
-            }
+        if (status.touch_status == pros::E_TOUCH_RELEASED && status.release_count != last_release_count) {
             last_release_count = status.release_count;
             g_last_ui_ms = pros::millis();
             g_show_selection_ui = true;
             const int x = status.x;
             const int y = status.y;
 
-            const Rect gps_btn{10, 10, 140, 30};
-            const Rect basic_btn{170, 10, 140, 30};
-            const Rect run_btn{330, 10, 140, 30};
-            const Rect rec_btn{330, 50, 140, 30};
-
-            if (hit_test(gps_btn, x, y)) g_auton_mode = AutonMode::GPS_LEMLIB;
-            if (hit_test(basic_btn, x, y)) g_auton_mode = AutonMode::NO_GPS;
-            if (hit_test(run_btn, x, y) && !g_auton_running) g_manual_auton_request = true;
-            if (hit_test(rec_btn, x, y)) {
+            if (hit_test(kUiLayout[kUiGps].rect, x, y)) g_auton_mode = AutonMode::GPS_LEMLIB;
+            if (hit_test(kUiLayout[kUiBasic].rect, x, y)) g_auton_mode = AutonMode::NO_GPS;
+            if (hit_test(kUiLayout[kUiRun].rect, x, y) && !g_auton_running) g_manual_auton_request = true;
+            if (hit_test(kUiLayout[kUiRec].rect, x, y)) {
                 bool recording = false;
-                record_status_snapshot(&recording, nullptr);
+                recorder::status(&recording, nullptr);
                 if (recording) {
                     stop_drive_recording("USER");
                 } else {
@@ -884,6 +1314,12 @@ void brain_ui_loop() {
             }
 
             draw_brain_ui();
+            last_refresh_ms = pros::millis();
+        } else if (g_show_selection_ui && (pros::millis() - last_refresh_ms) >= kUiRefreshMs) {
+            // Picks up changes made elsewhere (recorder drops, opcontrol starting a log);
+            // nothing is drawn unless a widget's text actually changed.
+            draw_brain_ui();
+            last_refresh_ms = pros::millis();
         }
         if (g_force_driver_image && g_show_selection_ui &&
             (pros::millis() - g_last_ui_ms) > kSelectionUiTimeoutMs) {
@@ -914,117 +1350,18 @@ void run_selected_auton() {
     stop_drive_recording("AUTON");
     show_run_image_once();
 
-    if (g_auton_mode == AutonMode::GPS_LEMLIB) {
-        if (g_sd_plans_loaded && !gps_plan_sd.empty()) {
-            for (const auto& step : gps_plan_sd) {
-                if (auton_time_up()) break;
-                switch (step.type) {
-                    case StepType::EMPTY:
-                        break;
-                    case StepType::DRIVE_MS:
-                        drive_set(step.value1, step.value1);
-                        if (!delay_with_abort(step.value2)) {
-                            stop_all_motors();
-                            break;
-                        }
-                        drive_brake();
-                        break;
-                    case StepType::TANK_MS:
-                        drive_set(step.value1, step.value2);
-                        if (!delay_with_abort(step.value3)) {
-                            stop_all_motors();
-                            break;
-                        }
-                        drive_brake();
-                        break;
-                    case StepType::TURN_HEADING:
-                        turn_to_heading(step.value1, 60);
-                        break;
-                    case StepType::WAIT_MS:
-                        if (!delay_with_abort(step.value1)) {
-                            stop_all_motors();
-                            break;
-                        }
-                        break;
-                    case StepType::INTAKE_ON:
-                        intake.move(127);
-                        outake.move(127);
-                        break;
-                    case StepType::INTAKE_OFF:
-                        intake.brake();
-                        outake.brake();
-                        break;
-                    case StepType::OUTTAKE_ON:
-                        intake.move(-127);
-                        outake.move(-127);
-                        break;
-                    case StepType::OUTTAKE_OFF:
-                        intake.brake();
-                        outake.brake();
-                        break;
-                }
-                if (auton_time_up()) break;
-            }
-        } else {
-            run_simple_auton_fallback();
-        }
-    } else {
-        if (g_sd_plans_loaded && !basic_plan_sd.empty()) {
-            for (const auto& step : basic_plan_sd) {
-                if (auton_time_up()) break;
-                switch (step.type) {
-                    case StepType::EMPTY:
-                        break;
-                    case StepType::DRIVE_MS:
-                        drive_set(step.value1, step.value1);
-                        if (!delay_with_abort(step.value2)) {
-                            stop_all_motors();
-                            break;
-                        }
-                        drive_brake();
-                        break;
-                    case StepType::TANK_MS:
-                        drive_set(step.value1, step.value2);
-                        if (!delay_with_abort(step.value3)) {
-                            stop_all_motors();
-                            break;
-                        }
-                        drive_brake();
-                        break;
-                    case StepType::TURN_HEADING:
-                        turn_to_heading(step.value1, 60);
-                        break;
-                    case StepType::WAIT_MS:
-                        if (!delay_with_abort(step.value1)) {
-                            stop_all_motors();
-                            break;
-                        }
-                        break;
-                    case StepType::INTAKE_ON:
-                        intake.move(127);
-                        outake.move(127);
-                        break;
-                    case StepType::INTAKE_OFF:
-                        intake.brake();
-                        outake.brake();
-                        break;
-                    case StepType::OUTTAKE_ON:
-                        intake.move(-127);
-                        outake.move(-127);
-                        break;
-                    case StepType::OUTTAKE_OFF:
-                        intake.brake();
-                        outake.brake();
-                        break;
-                }
-                if (auton_time_up()) break;
-            }
-        } else {
-            run_simple_auton_fallback();
-        }
-    }
+    const std::vector<Step>& sd_plan = g_auton_mode == AutonMode::GPS_LEMLIB ? gps_plan_sd : basic_plan_sd;
+    const std::vector<Step>& plan = (g_sd_plans_loaded && !sd_plan.empty()) ? sd_plan : kFallbackPlan;
+    auton_steps::Options options;
+    options.tick_ms = kAutonTickMs;
+    options.slew_per_tick = kAutonSlewPerTick;
+    odom_reset();
+    g_motion_step = nullptr;
+    auton_steps::run_plan(plan, auton_hardware(), options, &g_auton_profile);
 
+    cancel_motion();
     stop_all_motors();
+    save_auton_profile();
     g_auton_mutex.take();
     g_auton_running = false;
     g_auton_end_ms = 0;
@@ -1067,19 +1404,6 @@ void update_auton_mode_from_controller(bool gps_enable_pressed,
     }
 }
 
-StepType parse_step_type(const std::string& token) {
-    if (token == "EMPTY") return StepType::EMPTY;
-    if (token == "DRIVE_MS") return StepType::DRIVE_MS;
-    if (token == "TANK_MS") return StepType::TANK_MS;
-    if (token == "TURN_HEADING") return StepType::TURN_HEADING;
-    if (token == "WAIT_MS") return StepType::WAIT_MS;
-    if (token == "INTAKE_ON") return StepType::INTAKE_ON;
-    if (token == "INTAKE_OFF") return StepType::INTAKE_OFF;
-    if (token == "OUTTAKE_ON") return StepType::OUTTAKE_ON;
-    if (token == "OUTTAKE_OFF") return StepType::OUTTAKE_OFF;
-    return StepType::EMPTY;
-}
-
 const char* slot_filename(int slot) {
     switch (slot) {
         case 0: return kSlot1File;
@@ -1090,7 +1414,7 @@ const char* slot_filename(int slot) {
 }
 
 int read_slot_from_sd() {
-    FILE* file = sd_open(kSlotIndexFile, "r");
+    FILE* file = sd_manifest::open(kSlotIndexFile, "r");
     if (!file) {
         return 0;
     }
@@ -1110,7 +1434,7 @@ bool load_sd_plans_from(const char* filename) {
     gps_plan_sd.clear();
     basic_plan_sd.clear();
 
-    FILE* file = sd_open(filename, "r");
+    FILE* file = sd_manifest::open(filename, "r");
     if (!file) {
         return false;
     }
@@ -1133,13 +1457,8 @@ bool load_sd_plans_from(const char* filename) {
             continue;
         }
 
-        char type_str[32];
-        int v1 = 0;
-        int v2 = 0;
-        int v3 = 0;
-        const int fields = std::sscanf(s.c_str(), "%31[^,],%d,%d,%d", type_str, &v1, &v2, &v3);
-        if (fields >= 3) {
-            Step step{parse_step_type(type_str), v1, v2, v3};
+        Step step{};
+        if (auton_steps::parse_step_line(s.c_str(), &step)) {
             if (section == Section::GPS) gps_plan_sd.push_back(step);
             if (section == Section::BASIC) basic_plan_sd.push_back(step);
         }
@@ -1152,66 +1471,35 @@ bool load_sd_plans_from(const char* filename) {
 void load_sd_plans() {
     g_active_slot = read_slot_from_sd();
     const char* slot_file = slot_filename(g_active_slot);
-    if (load_sd_plans_from(slot_file)) {
-        g_sd_plans_loaded = true;
-        return;
-    }
-    if (load_sd_plans_from("auton_plans.txt")) {
-        g_sd_plans_loaded = true;
-        return;
-    }
-    g_sd_plans_loaded = false;
+    g_sd_plans_loaded = load_sd_plans_from(slot_file) || load_sd_plans_from("auton_plans.txt");
+    g_auton_paths.clear();
+    load_auton_paths(gps_plan_sd);
+    load_auton_paths(basic_plan_sd);
 }
 
 // ======================================================
 // 2. HELPER FUNCTIONS
 // ======================================================
 
-void turn_to_heading(double target, int max_speed) {
-    while (true) {
-        if (auton_time_up()) break;
-        double current = imu.get_heading();
-        double error = target - current;
-
-        if (error > 180) error -= 360;
-        if (error < -180) error += 360;
-
-        if (std::abs(error) < 2.0) break;
-
-        double kp = 1.5; 
-        int speed = error * kp;
-
-        if (speed > max_speed) speed = max_speed;
-        if (speed < -max_speed) speed = -max_speed;
-
-        drive_set(speed, -speed);
-        pros::delay(20);
-    }
-    drive_brake();
-}
+// One P-control update towards target; true once within 2 degrees. The step engine
+// calls it every tick (so other lanes keep running during a turn) and brakes after.
+bool turn_toward_heading(double target, int max_speed) {
+    double current = imu.get_heading();
+    double error = target - current;
 
-void run_simple_auton_fallback() {
-    drive_set(60, 60);
-    if (!delay_with_abort(1500)) {
-        stop_all_motors();
-        return;
-    }
+    if (error > 180) error -= 360;
+    if (error < -180) error += 360;
 
-    drive_brake();
-    if (!delay_with_abort(100)) {
-        stop_all_motors();
-        return;
-    }
+    if (std::abs(error) < 2.0) return true;
 
-    turn_to_heading(90, 60);
+    double kp = 1.5;
+    int speed = error * kp;
 
-    drive_set(-40, -40);
-    if (!delay_with_abort(500)) {
-        stop_all_motors();
-        return;
-    }
+    if (speed > max_speed) speed = max_speed;
+    if (speed < -max_speed) speed = -max_speed;
 
-    drive_brake();
+    drive_set(speed, -speed);
+    return false;
 }
 
 // ======================================================
@@ -1220,24 +1508,42 @@ void run_simple_auton_fallback() {
 
 void initialize() {
     pros::lcd::initialize();
+    sd_manifest::probe_layout();
     load_ui_images();
+    preload_ui_images();
     load_controller_mapping_from_sd();
+    load_record_config();
+    const int recovered_logs = recorder::recover_logs();
     show_init_splash();
     pros::delay(kSplashHoldMs);
     imu.reset(true);
     while (imu.is_calibrating()) {
         pros::delay(10);
     }
+    static pros::Task odom_task(odom_task_fn, nullptr, TASK_PRIORITY_DEFAULT + 1, TASK_STACK_DEPTH_DEFAULT,
+                                "TaheraOdom");
+    register_motion_steps();
     load_sd_plans();
     if (!g_sd_plans_loaded) {
         pros::lcd::print(0, "SD plans: MISSING");
     } else {
         pros::lcd::print(0, "SD plans: OK");
     }
+    if (recovered_logs > 0) {
+        pros::lcd::print(1, "Recovered logs: %d", recovered_logs);
+    }
+    pros::lcd::print(2, "SD cache: %u probes saved", static_cast<unsigned>(sd_manifest::probes_saved()));
+    pros::lcd::print(3, "Images cached: %u (%u KB)", static_cast<unsigned>(g_image_cache.images.size()),
+                     static_cast<unsigned>(g_image_cache.bytes / 1024));
     static pros::Task brain_ui_task(brain_ui_task_fn, nullptr, TASK_PRIORITY_DEFAULT,
                                     TASK_STACK_DEPTH_DEFAULT, "TaheraUI");
     static pros::Task auton_watchdog(auton_watchdog_task_fn, nullptr, TASK_PRIORITY_DEFAULT,
                                      TASK_STACK_DEPTH_DEFAULT, "TaheraWatch");
+    recorder::start_writer_task(TASK_PRIORITY_MIN + 1, "TaheraRecWriter");
+}
+
+void competition_initialize() {
+    preload_ui_images();
 }
 
 void autonomous() {
@@ -1430,6 +1736,7 @@ void opcontrol() {
                            six_on_pressed, six_off_pressed,
                            dpad_up_pressed, dpad_down_pressed,
                            dpad_left_pressed, dpad_right_pressed);
+        record_telemetry_tick();
 
         prev_intake_in = intake_in_now;
         prev_intake_out = intake_out_now;
@@ -5,7 +5,7 @@ using System.IO;
 
 namespace BonkersFieldReplayWin;
 
-internal sealed record LogSample(double Time, double Axis1, double Axis2, double Axis3, double Axis4, string Action);
+internal sealed record LogSample(double Time, double Axis1, double Axis2, double Axis3, double Axis4, string Action, double? Heading = null);
 
 internal sealed record Pose(double T, double X, double Y, double Theta,
     double LeftCmd, double RightCmd, double Axis1, double Axis2, double Axis3, double Axis4, string Action);
@@ -80,6 +80,7 @@ internal static class ReplayEngine
         double? axis3 = null;
         double? axis4 = null;
         var lastAction = string.Empty;
+        double? lastHeading = null;
         var t = 0.0;
 
         foreach (var raw in lines)
@@ -108,6 +109,48 @@ internal static class ReplayEngine
             {
                 axis4 = ParseDouble(value);
             }
+            else if (type.Equals("TELEM", StringComparison.OrdinalIgnoreCase))
+            {
+                // Motor/IMU telemetry track; only the IMU heading is used for replay.
+                lastHeading = ParseTelemetryHeading(value) ?? lastHeading;
+                continue;
+            }
+            else if (type.Equals("CHECKPOINT", StringComparison.OrdinalIgnoreCase))
+            {
+                // Segment CRC written by the brain for crash recovery; not a driver action.
+                continue;
+            }
+            else if (type.Equals("DT_US", StringComparison.OrdinalIgnoreCase))
+            {
+                // Measured period before the next sample; replaces the 20 ms assumption.
+                if (results.Count > 0 && double.TryParse(value, NumberStyles.Float, CultureInfo.InvariantCulture, out var dtUs) && dtUs > 0)
+                {
+                    t = results[^1].Time + dtUs / 1_000_000.0;
+                }
+                continue;
+            }
+            else if (type.Equals("REPEAT", StringComparison.OrdinalIgnoreCase))
+            {
+                // Delta-mode logs: the previous sample held for N more ticks. "REPEAT : N US"
+                // carries their summed period; older logs without it mean 20 ms ticks.
+                var fields = value.Split(' ', StringSplitOptions.RemoveEmptyEntries);
+                if (results.Count > 0 && fields.Length > 0 &&
+                    int.TryParse(fields[0], NumberStyles.Integer, CultureInfo.InvariantCulture, out var repeat) && repeat > 0)
+                {
+                    var last = results[^1];
+                    var step = fields.Length > 1 &&
+                               double.TryParse(fields[1], NumberStyles.Float, CultureInfo.InvariantCulture, out var totalUs) && totalUs > 0
+                        ? totalUs / 1_000_000.0 / repeat
+                        : 0.02;
+                    t = last.Time + step;
+                    for (var i = 0; i < repeat; i++)
+                    {
+                        results.Add(last with { Time = t });
+                        t += step;
+                    }
+                }
+                continue;
+            }
             else
             {
                 lastAction = $"{type} : {value}";
@@ -115,7 +158,7 @@ internal static class ReplayEngine
 
             if (axis1.HasValue && axis2.HasValue && axis3.HasValue && axis4.HasValue)
             {
-                results.Add(new LogSample(t, axis1.Value, axis2.Value, axis3.Value, axis4.Value, lastAction));
+                results.Add(new LogSample(t, axis1.Value, axis2.Value, axis3.Value, axis4.Value, lastAction, lastHeading));
                 axis1 = axis2 = axis3 = axis4 = null;
                 t += 0.02;
             }
@@ -124,6 +167,19 @@ internal static class ReplayEngine
         return results;
     }
 
+    private static double? ParseTelemetryHeading(string value)
+    {
+        foreach (var token in value.Split(' ', StringSplitOptions.RemoveEmptyEntries))
+        {
+            if (token.StartsWith("H=", StringComparison.OrdinalIgnoreCase) &&
+                double.TryParse(token.AsSpan(2), NumberStyles.Float, CultureInfo.InvariantCulture, out var heading))
+            {
+                return heading;
+            }
+        }
+        return null;
+    }
+
     public static List<Pose> Integrate(List<LogSample> samples, ReplaySettings settings)
     {
         var poses = new List<Pose>();
@@ -135,6 +191,7 @@ internal static class ReplayEngine
         var x = settings.FieldSizeIn / 2.0;
         var y = settings.FieldSizeIn / 2.0;
         var theta = 0.0;
+        double? headingOffset = null;
         double? lastT = null;
 
         foreach (var sample in samples)
@@ -161,6 +218,13 @@ internal static class ReplayEngine
                 theta += omega * dt;
             }
 
+            if (sample.Heading is double heading)
+            {
+                // IMU heading is clockwise degrees; anchor it to the pose at the first telemetry tick.
+                headingOffset ??= theta + heading * Math.PI / 180.0;
+                theta = headingOffset.Value - heading * Math.PI / 180.0;
+            }
+
             poses.Add(new Pose(sample.Time, x, y, theta,
                 leftCmd, rightCmd,
                 sample.Axis1, sample.Axis2, sample.Axis3, sample.Axis4,
@@ -1181,6 +1181,7 @@ namespace Tahera {
             double? axis3 = null;
             double? axis4 = null;
             var lastAction = string.Empty;
+            double? lastHeading = null;
             var t = 0.0;
 
             foreach (var raw in lines) {
@@ -1196,10 +1197,45 @@ namespace Tahera {
                 else if (type == "AXIS2") axis2 = ParseDouble(value);
                 else if (type == "AXIS3") axis3 = ParseDouble(value);
                 else if (type == "AXIS4") axis4 = ParseDouble(value);
+                else if (type == "TELEM") {
+                    // Motor/IMU telemetry track; only the IMU heading is used for replay.
+                    lastHeading = ParseTelemetryHeading(value) ?? lastHeading;
+                    continue;
+                }
+                else if (type == "CHECKPOINT") {
+                    // Segment CRC written by the brain for crash recovery; not a driver action.
+                    continue;
+                }
+                else if (type == "DT_US") {
+                    // Measured period before the next sample; replaces the fixed tick.
+                    if (result.Count > 0 && double.TryParse(value, NumberStyles.Float, CultureInfo.InvariantCulture, out var dtUs) && dtUs > 0) {
+                        t = result[^1].Time + dtUs / 1_000_000.0;
+                    }
+                    continue;
+                }
+                else if (type == "REPEAT") {
+                    // Delta-mode logs: the previous sample held for N more ticks. "REPEAT : N US"
+                    // carries their summed period; older logs without it mean fixed ticks.
+                    var fields = value.Split(' ', StringSplitOptions.RemoveEmptyEntries);
+                    if (result.Count > 0 && fields.Length > 0 &&
+                        int.TryParse(fields[0], NumberStyles.Integer, CultureInfo.InvariantCulture, out var repeat) && repeat > 0) {
+                        var last = result[^1];
+                        var step = fields.Length > 1 &&
+                                   double.TryParse(fields[1], NumberStyles.Float, CultureInfo.InvariantCulture, out var totalUs) && totalUs > 0
+                            ? totalUs / 1_000_000.0 / repeat
+                            : ReplayDtFallback;
+                        t = last.Time + step;
+                        for (var i = 0; i < repeat; i++) {
+                            result.Add(last with { Time = t });
+                            t += step;
+                        }
+                    }
+                    continue;
+                }
                 else lastAction = $"{type} : {value}";
 
                 if (axis1.HasValue && axis2.HasValue && axis3.HasValue && axis4.HasValue) {
-                    result.Add(new ReplaySample(t, axis1.Value, axis2.Value, axis3.Value, axis4.Value, lastAction));
+                    result.Add(new ReplaySample(t, axis1.Value, axis2.Value, axis3.Value, axis4.Value, lastAction, lastHeading));
                     axis1 = axis2 = axis3 = axis4 = null;
                     t += ReplayDtFallback;
                 }
@@ -1208,6 +1244,16 @@ namespace Tahera {
             return result;
         }
 
+        private static double? ParseTelemetryHeading(string value) {
+            foreach (var token in value.Split(' ', StringSplitOptions.RemoveEmptyEntries)) {
+                if (token.StartsWith("H=", StringComparison.OrdinalIgnoreCase) &&
+                    double.TryParse(token.AsSpan(2), NumberStyles.Float, CultureInfo.InvariantCulture, out var heading)) {
+                    return heading;
+                }
+            }
+            return null;
+        }
+
         private static List<ReplayPose> IntegrateReplay(List<ReplaySample> samples) {
             var poses = new List<ReplayPose>();
             if (samples.Count == 0) return poses;
@@ -1215,6 +1261,7 @@ namespace Tahera {
             var x = ReplayFieldSizeIn / 2.0;
             var y = ReplayFieldSizeIn / 2.0;
             var theta = 0.0;
+            double? headingOffset = null;
             double? lastT = null;
 
             foreach (var sample in samples) {
@@ -1238,6 +1285,12 @@ namespace Tahera {
                     theta += omega * dt;
                 }
 
+                if (sample.Heading is double heading) {
+                    // IMU heading is clockwise degrees; anchor it to the pose at the first telemetry tick.
+                    headingOffset ??= theta + heading * Math.PI / 180.0;
+                    theta = headingOffset.Value - heading * Math.PI / 180.0;
+                }
+
                 poses.Add(new ReplayPose(
                     sample.Time,
                     x,
@@ -1266,7 +1319,7 @@ namespace Tahera {
         }
 
         private sealed record PortAssignment(string Short, string Title, int Port, Color Color);
-        private sealed record ReplaySample(double Time, double Axis1, double Axis2, double Axis3, double Axis4, string Action);
+        private sealed record ReplaySample(double Time, double Axis1, double Axis2, double Axis3, double Axis4, string Action, double? Heading = null);
 
         private sealed record ReplayPose(
             double T,
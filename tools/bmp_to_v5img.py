@@ -0,0 +1,347 @@
+#!/usr/bin/env python3
+"""
+BMP -> .v5img (screen-ready image for the V5 brain).
+
+Usage:
+  python3 tools/bmp_to_v5img.py /Volumes/MICROBONK/Images
+  python3 tools/bmp_to_v5img.py splash.bmp jerkbot.bmp
+
+Outputs:
+  <name>.v5img next to each BMP, and a raw 112x56-or-smaller thumbnail at
+  .thumbs/<name>.bmp.v5img for Image Selector's GRID view (--no-thumbs skips
+  those). Files already newer than the BMP are left alone unless --force is set. Tahera, Auton Planner and Image Selector draw the
+  .v5img instead of the BMP when the SD manifest lists it.
+
+Format (little-endian):
+  16-byte header  "V5IM", u16 version=1, u16 width, u16 height, u16 encoding,
+                  u32 pixel data offset
+  pixels          width * height 0x00RRGGBB pixels, top-down, no row padding.
+                  encoding 0: raw u32 words. encoding 1 (default): a QOI op
+                  stream (https://qoiformat.org, no header/end marker, alpha
+                  fixed at 255), which the brain decodes in one streaming pass.
+                  --raw forces encoding 0.
+Images larger than 480x240 are scaled down with their aspect ratio kept, using
+the same fixed-point filter the brain applies to BMPs (--filter, default box),
+and centred on a black 480x240 frame so they land where the BMP would.
+"""
+
+import argparse
+import array
+import os
+import struct
+import sys
+
+MAGIC = b"V5IM"
+VERSION = 1
+HEADER = struct.Struct("<4sHHHHI")
+ENCODING_RAW = 0
+ENCODING_QOI = 1
+SCREEN_W = 480
+SCREEN_H = 240
+THUMB_W = 112
+THUMB_H = 56
+THUMB_DIR = ".thumbs"
+
+
+def fit_screen(width, height):
+    """Target size for an oversized image; matches read_bmp_info on the brain."""
+    if width <= SCREEN_W and height <= SCREEN_H:
+        return width, height
+    if width * SCREEN_H >= height * SCREEN_W:
+        return SCREEN_W, max(1, (height * SCREEN_W + width // 2) // width)
+    return max(1, (width * SCREEN_H + height // 2) // height), SCREEN_H
+
+
+def center_q8(t, target, src):
+    pos = ((2 * t + 1) * src * 128) // target - 128
+    return max(0, min(pos, (src - 1) * 256))
+
+
+def scale(src, width, height, target_w, target_h, mode):
+    """src is a top-down list of rows of (r, g, b); same integer maths as scale_bmp_row."""
+    out = array.array("I", bytes(4 * target_w * target_h))
+    if mode == "box":
+        cols = [(c * width // target_w, max(1, (c + 1) * width // target_w - c * width // target_w))
+                for c in range(target_w)]
+        for ty in range(target_h):
+            y0 = ty * height // target_h
+            count = max(1, (ty + 1) * height // target_h - y0)
+            inv_h = 65536 // count
+            for col, (x0, span) in enumerate(cols):
+                inv = 65536 // span
+                acc = [0, 0, 0]
+                for row in src[y0:y0 + count]:
+                    block = row[x0:x0 + span]
+                    for ch in range(3):
+                        acc[ch] += (sum(px[ch] for px in block) * inv) >> 8
+                r, g, b = (min(255, (value * inv_h) >> 24) for value in acc)
+                out[ty * target_w + col] = (r << 16) | (g << 8) | b
+    elif mode == "bilinear":
+        cols = []
+        for c in range(target_w):
+            pos = center_q8(c, target_w, width)
+            x0 = pos >> 8
+            cols.append((x0, (pos & 0xFF) if x0 + 1 < width else 0))
+        for ty in range(target_h):
+            pos = center_q8(ty, target_h, height)
+            y0, fy = pos >> 8, pos & 0xFF
+            top = src[y0]
+            bottom = src[y0 + 1] if fy and y0 + 1 < height else top
+            for col, (x0, fx) in enumerate(cols):
+                x1 = x0 + 1 if fx else x0
+                px = 0
+                for ch in range(3):
+                    upper = top[x0][ch] * (256 - fx) + top[x1][ch] * fx
+                    lower = bottom[x0][ch] * (256 - fx) + bottom[x1][ch] * fx
+                    px = (px << 8) | ((upper * (256 - fy) + lower * fy + 32768) >> 16)
+                out[ty * target_w + col] = px
+    else:
+        cols = [center_q8(c, target_w, width) >> 8 for c in range(target_w)]
+        for ty in range(target_h):
+            row = src[center_q8(ty, target_h, height) >> 8]
+            for col, x in enumerate(cols):
+                r, g, b = row[x]
+                out[ty * target_w + col] = (r << 16) | (g << 8) | b
+    return out
+
+
+def letterbox(pixels, width, height):
+    """Centres a scaled image on a black full-screen frame."""
+    if width == SCREEN_W and height == SCREEN_H:
+        return pixels
+    frame = array.array("I", bytes(4 * SCREEN_W * SCREEN_H))
+    off_x = (SCREEN_W - width) // 2
+    off_y = (SCREEN_H - height) // 2
+    for y in range(height):
+        start = (off_y + y) * SCREEN_W + off_x
+        frame[start:start + width] = pixels[y * width:(y + 1) * width]
+    return frame
+
+
+def channel_table(mask):
+    """(shift, field mask, 8-bit value per field value) for one 16-bit channel mask."""
+    shift = 0
+    while mask and not mask & (1 << shift):
+        shift += 1
+    field = mask >> shift
+    if field & (field + 1) or field > 0xFF:
+        raise ValueError(f"unsupported channel mask {mask:#x}")
+    return shift, field, [(v * 255 + field // 2) // field if field else 0 for v in range(field + 1)]
+
+
+def load_bmp_rows(path):
+    """Returns width, height and the top-down rows of (r, g, b) tuples.
+
+    Handles 1/4/8-bit palettized, 16-bit (RGB555, or BI_BITFIELDS masks) and 24/32-bit
+    BMPs, expanding colours the same way read_bmp_info/convert_bmp_row do on the brain.
+    """
+    with open(path, "rb") as f:
+        data = f.read()
+    if len(data) < 54 or data[:2] != b"BM":
+        raise ValueError("not a BMP")
+    data_offset = struct.unpack_from("<I", data, 10)[0]
+    dib_size = struct.unpack_from("<I", data, 14)[0]
+    width, height = struct.unpack_from("<ii", data, 18)
+    bpp = struct.unpack_from("<H", data, 28)[0]
+    compression = struct.unpack_from("<I", data, 30)[0]
+    colors_used = struct.unpack_from("<I", data, 46)[0]
+    compression_ok = compression == 0 or (compression == 3 and bpp in (16, 32))
+    if bpp not in (1, 4, 8, 16, 24, 32) or not compression_ok or dib_size < 40 or width <= 0 or height == 0:
+        raise ValueError(f"unsupported BMP ({bpp} bpp, compression {compression})")
+
+    top_down = height < 0
+    rows = abs(height)
+    row_size = ((bpp * width + 31) // 32) * 4
+    if data_offset + rows * row_size > len(data):
+        raise ValueError("truncated pixel data")
+
+    if bpp <= 8:
+        entries = 1 << bpp
+        stored = entries if colors_used == 0 or colors_used > entries else colors_used
+        base = 14 + dib_size
+        palette = [(data[base + i * 4 + 2], data[base + i * 4 + 1], data[base + i * 4]) for i in range(stored)]
+        palette += [(0, 0, 0)] * (entries - stored)
+        per_byte = 8 // bpp
+        index_mask = entries - 1
+
+        def decode_row(start):
+            out = []
+            for x in range(width):
+                shift = (per_byte - 1 - x % per_byte) * bpp
+                out.append(palette[(data[start + x // per_byte] >> shift) & index_mask])
+            return out
+    elif bpp == 16:
+        masks = struct.unpack_from("<III", data, 54) if compression == 3 else (0x7C00, 0x03E0, 0x001F)
+        (rs, rm, rt), (gs, gm, gt), (bs, bm, bt) = (channel_table(m) for m in masks)
+
+        def decode_row(start):
+            out = []
+            for x in range(width):
+                v = data[start + 2 * x] | (data[start + 2 * x + 1] << 8)
+                out.append((rt[(v >> rs) & rm], gt[(v >> gs) & gm], bt[(v >> bs) & bm]))
+            return out
+    else:
+        bytes_pp = bpp // 8
+
+        def decode_row(start):
+            return [(data[i + 2], data[i + 1], data[i]) for i in range(start, start + width * bytes_pp, bytes_pp)]
+
+    src = []
+    for draw_y in range(rows):
+        src.append(decode_row(data_offset + (draw_y if top_down else rows - 1 - draw_y) * row_size))
+    return width, rows, src
+
+
+def screen_pixels(src, width, rows, mode="box"):
+    """The .v5img body for a BMP: as is, or scaled and letterboxed to 480x240."""
+    target_w, target_h = fit_screen(width, rows)
+    if (target_w, target_h) == (width, rows):
+        pixels = array.array("I", ((r << 16) | (g << 8) | b for row in src for r, g, b in row))
+        return width, rows, pixels
+    pixels = scale(src, width, rows, target_w, target_h, mode)
+    return SCREEN_W, SCREEN_H, letterbox(pixels, target_w, target_h)
+
+
+def read_bmp(path, mode="box"):
+    width, rows, src = load_bmp_rows(path)
+    return screen_pixels(src, width, rows, mode)
+
+
+def make_thumb(src, width, height):
+    """Box average onto at most THUMB_W x THUMB_H; matches build_thumb in Image Selector."""
+    if width * THUMB_H >= height * THUMB_W:
+        thumb_w = min(width, THUMB_W)
+        thumb_h = max(1, (height * thumb_w + width // 2) // width)
+    else:
+        thumb_h = min(height, THUMB_H)
+        thumb_w = max(1, (width * thumb_h + height // 2) // height)
+    col_of = [x * thumb_w // width for x in range(width)]
+    sums = [[0, 0, 0, 0] for _ in range(thumb_w * thumb_h)]
+    for y, row in enumerate(src):
+        base = (y * thumb_h // height) * thumb_w
+        for x, (r, g, b) in enumerate(row):
+            cell = sums[base + col_of[x]]
+            cell[0] += r
+            cell[1] += g
+            cell[2] += b
+            cell[3] += 1
+    pixels = array.array("I", bytes(4 * thumb_w * thumb_h))
+    for idx, (r, g, b, count) in enumerate(sums):
+        count = max(1, count)
+        half = count // 2
+        pixels[idx] = (((r + half) // count) << 16) | (((g + half) // count) << 8) | ((b + half) // count)
+    return thumb_w, thumb_h, pixels
+
+
+def qoi_hash(px):
+    return (((px >> 16) & 0xFF) * 3 + ((px >> 8) & 0xFF) * 5 + (px & 0xFF) * 7 + 255 * 11) % 64
+
+
+def encode_qoi(pixels):
+    out = bytearray()
+    index = [0] * 64
+    prev = 0
+    run = 0
+    for px in pixels:
+        if px == prev:
+            run += 1
+            if run == 62:
+                out.append(0xC0 | (run - 1))
+                run = 0
+            continue
+        if run:
+            out.append(0xC0 | (run - 1))
+            run = 0
+        slot = qoi_hash(px)
+        if index[slot] == px:
+            out.append(slot)
+        else:
+            index[slot] = px
+            dr = (((px >> 16) & 0xFF) - ((prev >> 16) & 0xFF) + 128) % 256 - 128
+            dg = (((px >> 8) & 0xFF) - ((prev >> 8) & 0xFF) + 128) % 256 - 128
+            db = ((px & 0xFF) - (prev & 0xFF) + 128) % 256 - 128
+            dr_dg = dr - dg
+            db_dg = db - dg
+            if -2 <= dr <= 1 and -2 <= dg <= 1 and -2 <= db <= 1:
+                out.append(0x40 | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2))
+            elif -32 <= dg <= 31 and -8 <= dr_dg <= 7 and -8 <= db_dg <= 7:
+                out.append(0x80 | (dg + 32))
+                out.append(((dr_dg + 8) << 4) | (db_dg + 8))
+            else:
+                out.extend((0xFE, (px >> 16) & 0xFF, (px >> 8) & 0xFF, px & 0xFF))
+        prev = px
+    if run:
+        out.append(0xC0 | (run - 1))
+    return bytes(out)
+
+
+def write_v5img(path, width, height, pixels, raw=False):
+    if raw:
+        encoding = ENCODING_RAW
+        if sys.byteorder != "little":
+            pixels.byteswap()
+        body = pixels.tobytes()
+    else:
+        encoding = ENCODING_QOI
+        body = encode_qoi(pixels)
+    with open(path, "wb") as f:
+        f.write(HEADER.pack(MAGIC, VERSION, width, height, encoding, HEADER.size))
+        f.write(body)
+    return HEADER.size + len(body)
+
+
+def collect(paths):
+    for path in paths:
+        if os.path.isdir(path):
+            for name in sorted(os.listdir(path)):
+                if name.lower().endswith(".bmp") and not name.startswith("."):
+                    yield os.path.join(path, name)
+        else:
+            yield path
+
+
+def up_to_date(out, source):
+    return os.path.exists(out) and os.path.getmtime(out) >= os.path.getmtime(source)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert BMPs to the brain-native .v5img format.")
+    parser.add_argument("paths", nargs="+", help="BMP files or folders of BMPs")
+    parser.add_argument("--force", action="store_true", help="Rewrite .v5img files that look up to date")
+    parser.add_argument("--raw", action="store_true", help="Store uncompressed pixels instead of QOI")
+    parser.add_argument("--filter", choices=("nearest", "box", "bilinear"), default="box",
+                        help="How images larger than 480x240 are scaled down (default: box)")
+    parser.add_argument("--no-thumbs", action="store_true", help="Do not write .thumbs/ sidecars")
+    args = parser.parse_args()
+
+    written = 0
+    thumbs = 0
+    for bmp in collect(args.paths):
+        out = os.path.splitext(bmp)[0] + ".v5img"
+        thumb_out = os.path.join(os.path.dirname(bmp), THUMB_DIR, os.path.basename(bmp) + ".v5img")
+        need_image = args.force or not up_to_date(out, bmp)
+        need_thumb = not args.no_thumbs and (args.force or not up_to_date(thumb_out, bmp))
+        if not need_image and not need_thumb:
+            continue
+        try:
+            width, rows, src = load_bmp_rows(bmp)
+        except (OSError, ValueError) as exc:
+            print(f"Skipping {bmp}: {exc}", file=sys.stderr)
+            continue
+        if need_image:
+            target_w, target_h, pixels = screen_pixels(src, width, rows, args.filter)
+            size = write_v5img(out, target_w, target_h, pixels, raw=args.raw)
+            ratio = os.path.getsize(bmp) / size
+            print(f"Wrote {out} ({target_w}x{target_h}, {size} bytes, {ratio:.1f}x smaller than the BMP)")
+            written += 1
+        if need_thumb:
+            os.makedirs(os.path.dirname(thumb_out), exist_ok=True)
+            thumb_w, thumb_h, pixels = make_thumb(src, width, rows)
+            write_v5img(thumb_out, thumb_w, thumb_h, pixels, raw=True)
+            thumbs += 1
+
+    print(f"Done. Wrote {written} .v5img file(s) and {thumbs} thumbnail(s).")
+
+
+if __name__ == "__main__":
+    main()
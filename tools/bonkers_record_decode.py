@@ -0,0 +1,282 @@
+#!/usr/bin/env python3
+"""
+Bonkers binary recording -> text controller log.
+
+Usage:
+  python3 tools/bonkers_record_decode.py /path/to/bonkers_log_XXXX.bin
+
+Outputs:
+  bonkers_log_XXXX.txt next to the recording unless --output is set. The text
+  matches what the brain writes in FORMAT=TEXT mode, so the Mac/Windows field
+  replay apps can load it unchanged.
+
+CHECKPOINT records/lines (segment CRCs written by the brain so it can repair
+logs after a brownout) are verified and dropped from the output.
+
+TELEMETRY_MS=N recordings carry a "TELEM : ..." line per sample; a per-motor
+peak current/temperature summary is printed after conversion, with the number
+of samples the brain dropped (REC_TELEMETRY_DROP) when its queue was full.
+
+Delta-mode recordings (DELTA=ON) are expanded back to one AXIS1..4 group per
+tick. REPEAT records carry the summed microseconds of the ticks they fold; it is
+spread evenly over them as DT_US lines (older recordings without it replay at
+20 ms). Text logs are accepted too; their "REPEAT : N US" lines are expanded in
+place (write them to a new file with --output).
+"""
+
+import argparse
+import os
+import struct
+import sys
+import zlib
+
+MAGIC = b"BNKR"
+HEADER = struct.Struct("<4sHHBB2x")
+FRAME = struct.Struct("<BxHIbbbb")
+STOP = struct.Struct("<B11s")
+COUNT = struct.Struct("<B3xI4x")
+REPEAT = struct.Struct("<B3xII")
+STATS = struct.Struct("<BxHHHH2x")
+CHECKPOINT = struct.Struct("<BxHII")
+TELEMETRY = struct.Struct("<BBHI4x")
+MOTOR = struct.Struct("<BBhiHBB")
+
+TAG_FRAME = 1
+TAG_STOP = 2
+TAG_OVERRUN = 3
+TAG_REPEAT = 4
+TAG_STATS = 5
+TAG_CHECKPOINT = 6
+TAG_TELEMETRY = 7
+TAG_MOTOR = 8
+TAG_TELEMETRY_DROP = 9
+
+# Index order of MOTOR records; matches kTelemetryMotorNames on the brain.
+TELEMETRY_MOTORS = ["LD", "RD", "LM", "RM", "IN", "OUT"]
+MOTOR_OVER_TEMP = 1
+MOTOR_OVER_CURRENT = 2
+
+DRIVE_MODES = ["TANK", "ARCADE_2_STICK", "DPAD"]
+NO_DRIVE_MODE = 0xFF
+
+# Bit order matches RecordButtonBit in Tahera_Project/src/main.cpp.
+TAHERA_BUTTONS = [
+    ("BTN_INTAKE_IN", "INTAKE_IN"),
+    ("BTN_INTAKE_OUT", "INTAKE_OUT"),
+    ("BTN_OUTAKE_OUT", "OUTAKE_OUT"),
+    ("BTN_OUTAKE_IN", "OUTAKE_IN"),
+    ("BTN_GPS_ENABLE", "GPS_ENABLE"),
+    ("BTN_GPS_DISABLE", "GPS_DISABLE"),
+    ("BTN_SIX_ON", "SIX_WHEEL_ON"),
+    ("BTN_SIX_OFF", "SIX_WHEEL_OFF"),
+    ("BTN_DPAD_UP", "DPAD_UP"),
+    ("BTN_DPAD_DOWN", "DPAD_DOWN"),
+    ("BTN_DPAD_LEFT", "DPAD_LEFT"),
+    ("BTN_DPAD_RIGHT", "DPAD_RIGHT"),
+]
+
+# Bit order matches kButtonNames in Basic_Bonkers_PROS/src/main.cpp.
+BASIC_BONKERS_BUTTONS = [
+    ("BTN_L1", "INTAKE_IN"),
+    ("BTN_L2", "INTAKE_OUT"),
+    ("BTN_R1", "OUTTAKE_OUT"),
+    ("BTN_R2", "OUTTAKE_IN"),
+    ("BTN_A", "NO_ACTION"),
+    ("BTN_B", "NO_ACTION"),
+    ("BTN_X", "NO_ACTION"),
+    ("BTN_Y", "NO_ACTION"),
+    ("BTN_UP", "NO_ACTION"),
+    ("BTN_DOWN", "NO_ACTION"),
+    ("BTN_LEFT", "NO_ACTION"),
+    ("BTN_RIGHT", "NO_ACTION"),
+]
+
+# recorder::Program in Bonkers_Recorder/include/bonkers_recorder.hpp (header byte 9, v4+).
+PROGRAMS = {
+    0: ("TAHERA", TAHERA_BUTTONS),
+    1: ("BASIC_BONKERS", BASIC_BONKERS_BUTTONS),
+}
+
+
+def axis_lines(axes):
+    return [f"AXIS{idx + 1} : {value}" for idx, value in enumerate(axes)]
+
+
+def telemetry_line(time_ms, heading_centideg, motors):
+    parts = [f"TELEM : {time_ms} H={heading_centideg // 100}.{heading_centideg % 100:02d}"]
+    for index, velocity, position, current, temperature, flags in motors:
+        name = TELEMETRY_MOTORS[index] if index < len(TELEMETRY_MOTORS) else f"M{index}"
+        text = f"{name}={velocity},{position},{current},{temperature}"
+        if flags & MOTOR_OVER_TEMP:
+            text += ",!T"
+        if flags & MOTOR_OVER_CURRENT:
+            text += ",!I"
+        parts.append(text)
+    return " ".join(parts)
+
+
+def telemetry_summary(lines):
+    peaks = {}
+    dropped = 0
+    for line in lines:
+        if line.startswith("REC_TELEMETRY_DROP"):
+            dropped += int(line.partition(":")[2].strip() or 0)
+            continue
+        if not line.startswith("TELEM"):
+            continue
+        for token in line.partition(":")[2].split()[2:]:
+            name, _, fields = token.partition("=")
+            values = fields.split(",")
+            if len(values) < 4:
+                continue
+            peak = peaks.setdefault(name, {"current": 0, "temp": 0, "flags": set()})
+            peak["current"] = max(peak["current"], int(values[2]))
+            peak["temp"] = max(peak["temp"], int(values[3]))
+            peak["flags"].update(v for v in values[4:] if v.startswith("!"))
+    for name, peak in peaks.items():
+        flags = " ".join(sorted(peak["flags"]))
+        print(f"  {name:<4} peak {peak['current']:5d} mA  {peak['temp']:3d} C  {flags}".rstrip())
+    if dropped:
+        print(f"  {dropped} telemetry samples dropped (queue full); the track has gaps")
+
+
+def repeat_lines(last_axes, count, total_us):
+    """The held AXIS group count more times, with total_us spread over the ticks."""
+    if not last_axes or count <= 0:
+        return []
+    if total_us <= 0:
+        return last_axes * count
+    lines = []
+    step, extra = divmod(total_us, count)
+    for tick in range(count):
+        lines.append(f"DT_US : {step + (1 if tick < extra else 0)}")
+        lines.extend(last_axes)
+    return lines
+
+
+def expand_text(text):
+    lines = []
+    last_axes = []
+    for raw in text.splitlines():
+        line = raw.strip()
+        kind, _, value = line.partition(":")
+        kind = kind.strip().upper()
+        if kind == "CHECKPOINT":
+            continue
+        if kind == "REPEAT":
+            fields = value.split()
+            try:
+                count = int(fields[0])
+                total_us = int(fields[1]) if len(fields) > 1 else 0
+            except (IndexError, ValueError):
+                count, total_us = 0, 0
+            lines.extend(repeat_lines(last_axes, count, total_us))
+            continue
+        if kind in ("AXIS1", "AXIS2", "AXIS3", "AXIS4"):
+            if kind == "AXIS1":
+                last_axes = []
+            last_axes.append(line)
+        lines.append(line)
+    return lines
+
+
+def decode(data):
+    if len(data) < HEADER.size:
+        raise SystemExit("Recording is too short to hold a header.")
+
+    magic, version, record_size, drive_mode, program = HEADER.unpack_from(data, 0)
+    if magic != MAGIC:
+        raise SystemExit("Not a Bonkers binary recording (bad magic).")
+    # v1 frames carry milliseconds since REC_START; v2 frames carry microseconds since
+    # the previous control tick, which is written out as a DT_US line. v3 adds checkpoints,
+    # v4 the program id, v5 the telemetry drop count.
+    if version not in (1, 2, 3, 4, 5) or record_size != FRAME.size:
+        raise SystemExit(f"Unsupported recording version {version} (record size {record_size}).")
+
+    program_name, buttons_table = PROGRAMS.get(program if version >= 4 else 0, PROGRAMS[0])
+    lines = [f"REC_START : {program_name}"]
+    if drive_mode != NO_DRIVE_MODE:
+        mode = DRIVE_MODES[drive_mode] if drive_mode < len(DRIVE_MODES) else "TANK"
+        lines.append(f"DRIVE_MODE : {mode}")
+
+    last_axes = None
+    offset = HEADER.size
+    segment_start = 0
+    while offset + record_size <= len(data):
+        tag = data[offset]
+        if tag == TAG_FRAME:
+            _, buttons, timing, a1, a2, a3, a4 = FRAME.unpack_from(data, offset)
+            if version >= 2:
+                lines.append(f"DT_US : {timing}")
+            last_axes = axis_lines((a1, a2, a3, a4))
+            lines.extend(last_axes)
+            for bit, (name, action) in enumerate(buttons_table):
+                if buttons & (1 << bit):
+                    lines.append(f"{name} : {action}")
+        elif tag == TAG_STOP:
+            _, reason = STOP.unpack_from(data, offset)
+            reason = reason.split(b"\0", 1)[0].decode("ascii", "replace")
+            lines.append(f"REC_STOP : {reason}")
+        elif tag == TAG_REPEAT:
+            _, count, total_us = REPEAT.unpack_from(data, offset)
+            lines.extend(repeat_lines(last_axes, count, total_us if version >= 2 else 0))
+        elif tag == TAG_STATS:
+            _, min_10us, max_10us, mean_10us, p99_10us = STATS.unpack_from(data, offset)
+            lines.append(f"LOOP_MIN_US : {min_10us * 10}")
+            lines.append(f"LOOP_MAX_US : {max_10us * 10}")
+            lines.append(f"LOOP_MEAN_US : {mean_10us * 10}")
+            lines.append(f"LOOP_P99_US : {p99_10us * 10}")
+        elif tag == TAG_CHECKPOINT:
+            _, segment, length, crc = CHECKPOINT.unpack_from(data, offset)
+            segment_bytes = data[segment_start:offset]
+            if length != len(segment_bytes) or zlib.crc32(segment_bytes) != crc:
+                print(f"Checkpoint {segment} at byte {offset} does not match its segment", file=sys.stderr)
+            segment_start = offset + record_size
+        elif tag == TAG_TELEMETRY:
+            _, motor_count, heading, time_ms = TELEMETRY.unpack_from(data, offset)
+            motors = []
+            for _ in range(motor_count):
+                offset += record_size
+                if offset + record_size > len(data) or data[offset] != TAG_MOTOR:
+                    break
+                motors.append(MOTOR.unpack_from(data, offset)[1:])
+            lines.append(telemetry_line(time_ms, heading, motors))
+        elif tag == TAG_OVERRUN:
+            _, count = COUNT.unpack_from(data, offset)
+            lines.append(f"REC_OVERRUN : {count}")
+        elif tag == TAG_TELEMETRY_DROP:
+            _, count = COUNT.unpack_from(data, offset)
+            lines.append(f"REC_TELEMETRY_DROP : {count}")
+        else:
+            print(f"Skipping unknown record tag {tag} at byte {offset}", file=sys.stderr)
+        offset += record_size
+
+    return lines
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert a Bonkers binary recording to the text log format.")
+    parser.add_argument("log", help="Path to bonkers_log_XXXX.bin (or a delta-mode .txt)")
+    parser.add_argument("--output", help="Output text path")
+    args = parser.parse_args()
+
+    with open(args.log, "rb") as f:
+        data = f.read()
+
+    if data[:len(MAGIC)] == MAGIC:
+        lines = decode(data)
+    else:
+        lines = expand_text(data.decode("utf-8", "replace"))
+
+    out_path = args.output or os.path.splitext(args.log)[0] + ".txt"
+    if os.path.abspath(out_path) == os.path.abspath(args.log):
+        raise SystemExit("Refusing to overwrite the input log; pass --output.")
+    with open(out_path, "w", encoding="utf-8") as f:
+        f.write("\n".join(lines) + "\n")
+
+    print(f"Wrote {out_path} ({len(lines)} lines)")
+    telemetry_summary(lines)
+
+
+if __name__ == "__main__":
+    main()
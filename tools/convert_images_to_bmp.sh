@@ -1,7 +1,8 @@
 #!/bin/bash
 set -euo pipefail
 
-# Convert images in the SD card Images folder to 480x240 BMPs.
+# Convert images in the SD card Images folder to 480x240 BMPs, plus a .v5img copy of
+# each BMP for the brain (see tools/bmp_to_v5img.py).
 # Usage: ./tools/convert_images_to_bmp.sh [images_dir]
 # Default images_dir: /Volumes/MICROBONK/Images
 
@@ -50,3 +51,9 @@ for file in "$IMAGES_DIR"/*; do
 done
 
 echo "Done. Converted $converted file(s) to BMP."
+
+# Brain-native copies (.v5img) of every BMP, then refresh the card's file index so the
+# programs see them.
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+python3 "$SCRIPT_DIR/bmp_to_v5img.py" "$IMAGES_DIR"
+python3 "$SCRIPT_DIR/sd_manifest.py" "$(dirname "$IMAGES_DIR")"
@@ -0,0 +1,60 @@
+#!/usr/bin/env python3
+"""
+Rebuild sd_manifest.txt on a mounted V5 microSD card.
+
+Usage:
+  python3 tools/sd_manifest.py /Volumes/V5SD
+
+Run it after copying images, plans or configs onto the card from a PC. The
+brain programs read /usd/sd_manifest.txt instead of listing directories, and
+only rescan by themselves when the manifest is missing (or on Image Selector's
+RESCAN button), so files copied over without it stay invisible until then.
+
+Format (one line per file in the card root, Images/ and Images/.thumbs/,
+oldest first):
+  seq,size,/usd/<path>
+seq is ordered by modification time here; on the brain it is a counter bumped
+on every write. When a path appears more than once the last line wins.
+"""
+
+import argparse
+import os
+
+MANIFEST_NAME = "sd_manifest.txt"
+SCAN_DIRS = ["", "Images", "Images/.thumbs"]
+
+
+def collect(card_root):
+    files = []
+    for sub in SCAN_DIRS:
+        folder = os.path.join(card_root, sub)
+        if not os.path.isdir(folder):
+            continue
+        for name in os.listdir(folder):
+            full = os.path.join(folder, name)
+            if name.startswith(".") or name == MANIFEST_NAME or not os.path.isfile(full):
+                continue
+            card_path = "/usd/" + (f"{sub}/{name}" if sub else name)
+            stat = os.stat(full)
+            files.append((stat.st_mtime, card_path, stat.st_size))
+    files.sort()
+    return files
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Rebuild the SD card manifest read by the brain programs.")
+    parser.add_argument("card", help="Mount point of the microSD card")
+    args = parser.parse_args()
+
+    files = collect(args.card)
+    out_path = os.path.join(args.card, MANIFEST_NAME)
+    with open(out_path, "w", encoding="ascii", newline="\n") as f:
+        f.write("# seq,size,path\n")
+        for seq, (_, card_path, size) in enumerate(files, start=1):
+            f.write(f"{seq},{size},{card_path}\n")
+
+    print(f"Wrote {out_path} ({len(files)} files)")
+
+
+if __name__ == "__main__":
+    main()